@@ -8,23 +8,47 @@ from typing import List
 
 WIDTH = 160
 HEIGHT = 144
-CHANNELS = 3
-BUFFER_SIZE = WIDTH * HEIGHT * CHANNELS
+
+# Pixel formats, matching GBC_PixelFormat
+PIXEL_FORMAT_RGB888 = 0
+PIXEL_FORMAT_RGBA8888 = 1
+PIXEL_FORMAT_XRGB8888 = 2
+PIXEL_FORMAT_RGB565 = 3
+PIXEL_FORMAT_RGB555 = 4
+PIXEL_FORMAT_INDEXED8 = 5
 
 GAME_BOY: ctypes.CDLL
-FRAME_BUFFER = (ctypes.c_uint8 * BUFFER_SIZE)()
+GBC: ctypes.c_void_p
 
 if sys.platform == "darwin":
     GAME_BOY = ctypes.CDLL("./GameBoy/lib/libGameBoy.dylib", winmode=0)
 elif sys.platform == "win32":
     GAME_BOY = ctypes.CDLL("./GameBoy/lib/libGameBoy.dll", winmode=0)
 
-GAME_BOY.Initialize.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.CFUNCTYPE(None)]
-GAME_BOY.InsertCartridge.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_char)]
+GAME_BOY.GBC_Create.restype = ctypes.c_void_p
+GAME_BOY.GBC_Destroy.argtypes = [ctypes.c_void_p]
+GAME_BOY.Initialize.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint8), ctypes.CFUNCTYPE(None, ctypes.c_void_p), ctypes.c_void_p]
+GAME_BOY.InsertCartridge.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_char)]
 GAME_BOY.InsertCartridge.restype = ctypes.c_bool
-GAME_BOY.PowerOn.argtypes = [ctypes.POINTER(ctypes.c_char)]
-GAME_BOY.CollectAudioSamples.argtypes = [ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+GAME_BOY.PowerOn.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_char)]
+GAME_BOY.CollectAudioSamples.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+GAME_BOY.StartEmulation.argtypes = [ctypes.c_void_p]
+GAME_BOY.StopEmulation.argtypes = [ctypes.c_void_p]
+GAME_BOY.ReadAudio.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+GAME_BOY.AcquireFrame.argtypes = [ctypes.c_void_p]
+GAME_BOY.AcquireFrame.restype = ctypes.c_void_p
+GAME_BOY.ReleaseFrame.argtypes = [ctypes.c_void_p]
+GAME_BOY.SetDisplayRefreshRate.argtypes = [ctypes.c_void_p, ctypes.c_double]
+GAME_BOY.ReadAudio.restype = ctypes.c_int
+GAME_BOY.RunFrames.argtypes = [ctypes.c_void_p, ctypes.c_int]
+GAME_BOY.RunFrames.restype = ctypes.c_int
+GAME_BOY.RunUntil.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+GAME_BOY.RunUntil.restype = ctypes.c_int
+GAME_BOY.GetCycleCount.argtypes = [ctypes.c_void_p]
+GAME_BOY.GetCycleCount.restype = ctypes.c_uint64
+GAME_BOY.SetAudioDecimation.argtypes = [ctypes.c_void_p, ctypes.c_int]
 GAME_BOY.SetInputs.argtypes = [
+    ctypes.c_void_p,
     ctypes.c_bool,
     ctypes.c_bool,
     ctypes.c_bool,
@@ -34,16 +58,47 @@ GAME_BOY.SetInputs.argtypes = [
     ctypes.c_bool,
     ctypes.c_bool
 ]
-GAME_BOY.SetClockMultiplier.argtypes = [ctypes.c_float]
-GAME_BOY.CreateSaveState.argtypes = [ctypes.POINTER(ctypes.c_char)]
-GAME_BOY.LoadSaveState.argtypes = [ctypes.POINTER(ctypes.c_char)]
-GAME_BOY.EnableSoundChannel.argtypes = [ctypes.c_int, ctypes.c_bool]
-GAME_BOY.SetMonoAudio.argtypes = [ctypes.c_bool]
-GAME_BOY.SetVolume.argtypes = [ctypes.c_float]
-GAME_BOY.SetSampleRate.argtypes = [ctypes.c_int]
-GAME_BOY.PreferDmgColors.argtypes = [ctypes.c_bool]
-GAME_BOY.UseIndividualPalettes.argtypes = [ctypes.c_bool]
-GAME_BOY.SetCustomPalette.argtypes = [ctypes.c_uint8, ctypes.POINTER(ctypes.c_uint8)]
+GAME_BOY.SetClockMultiplier.argtypes = [ctypes.c_void_p, ctypes.c_float]
+GAME_BOY.CreateSaveState.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_char)]
+GAME_BOY.LoadSaveState.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_char)]
+GAME_BOY.EnableSoundChannel.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_bool]
+GAME_BOY.SetMonoAudio.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+GAME_BOY.SetVolume.argtypes = [ctypes.c_void_p, ctypes.c_float]
+GAME_BOY.SetSampleRate.argtypes = [ctypes.c_void_p, ctypes.c_int]
+GAME_BOY.PreferDmgColors.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+GAME_BOY.UseIndividualPalettes.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+GAME_BOY.SetCustomPalette.argtypes = [ctypes.c_void_p, ctypes.c_uint8, ctypes.POINTER(ctypes.c_uint8)]
+GAME_BOY.SetInstructionStepping.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+GAME_BOY.SetScanlineRenderer.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+GAME_BOY.SetPixelFormat.argtypes = [ctypes.c_void_p, ctypes.c_int]
+GAME_BOY.GetPaletteTable.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint16)]
+GAME_BOY.SetFrameSkip.argtypes = [ctypes.c_void_p, ctypes.c_int]
+
+
+class BatchJob(ctypes.Structure):
+    """Mirror of GBC_BatchJob."""
+    _fields_ = [
+        ("rom_path", ctypes.c_char_p),
+        ("save_state_path", ctypes.c_char_p),
+        ("input_script_path", ctypes.c_char_p),
+        ("ram_dump_path", ctypes.c_char_p),
+        ("frames", ctypes.c_int),
+    ]
+
+
+class BatchResult(ctypes.Structure):
+    """Mirror of GBC_BatchResult."""
+    _fields_ = [
+        ("success", ctypes.c_bool),
+        ("frames_run", ctypes.c_int),
+        ("cycles_run", ctypes.c_uint64),
+        ("frame_hash", ctypes.c_uint64),
+    ]
+
+
+GAME_BOY.RunBatch.argtypes = [ctypes.POINTER(BatchJob), ctypes.POINTER(BatchResult), ctypes.c_int, ctypes.c_int]
+
+GBC = GAME_BOY.GBC_Create()
 
 @dataclass
 class JoyPad:
@@ -58,13 +113,13 @@ class JoyPad:
     a: bool
 
 
-def initialize_game_boy(update_screen_callback: ctypes.CFUNCTYPE(None)):
+def initialize_game_boy(update_screen_callback: ctypes.CFUNCTYPE(None, ctypes.c_void_p)):
     """Initialize the Game Boy library.
 
     Args:
         update_screen_callback: Function to call to refresh screen.
     """
-    GAME_BOY.Initialize(FRAME_BUFFER, update_screen_callback)
+    GAME_BOY.Initialize(GBC, None, update_screen_callback, None)
 
 
 def insert_cartridge(rom_path: str, save_directory: str) -> str:
@@ -84,7 +139,7 @@ def insert_cartridge(rom_path: str, save_directory: str) -> str:
     save_directory_buffer = ctypes.create_string_buffer(str.encode(save_directory))
     rom_name = ctypes.create_string_buffer(16)
 
-    success = GAME_BOY.InsertCartridge(rom_path_buffer, save_directory_buffer, rom_name)
+    success = GAME_BOY.InsertCartridge(GBC, rom_path_buffer, save_directory_buffer, rom_name)
 
     if success:
         rom_str = rom_name.value.decode()
@@ -101,7 +156,7 @@ def power_on(boot_rom_path: str):
         boot_rom_path: Path to boot ROM. If empty, game will bypass boot up screen and launch directly.
     """
     boot_rom_path_buffer = ctypes.create_string_buffer(str.encode(boot_rom_path))
-    GAME_BOY.PowerOn(boot_rom_path_buffer)
+    GAME_BOY.PowerOn(GBC, boot_rom_path_buffer)
 
 
 def set_joypad_state(joypad: JoyPad):
@@ -110,7 +165,7 @@ def set_joypad_state(joypad: JoyPad):
     Args:
         joypad: Current state of each joypad button.
     """
-    GAME_BOY.SetInputs(joypad.down, joypad.up, joypad.left, joypad.right, joypad.start, joypad.select, joypad.b, joypad.a)
+    GAME_BOY.SetInputs(GBC, joypad.down, joypad.up, joypad.left, joypad.right, joypad.start, joypad.select, joypad.b, joypad.a)
 
 
 def collect_audio_samples(buffer: ctypes.POINTER(ctypes.c_float), len: int):
@@ -120,30 +175,96 @@ def collect_audio_samples(buffer: ctypes.POINTER(ctypes.c_float), len: int):
         buffer: Pointer to audio buffer to be filled.
         len: Number of samples to collect.
     """
-    GAME_BOY.CollectAudioSamples(buffer, len)
+    GAME_BOY.CollectAudioSamples(GBC, buffer, len)
+
+
+def start_emulation():
+    """Start running the Game Boy on its own thread, paced by how fast audio is read with read_audio."""
+    GAME_BOY.StartEmulation(GBC)
+
+
+def stop_emulation():
+    """Stop the emulation thread started by start_emulation."""
+    GAME_BOY.StopEmulation(GBC)
+
+
+def set_display_refresh_rate(refresh_rate: float):
+    """Pace the emulation thread to the display so that frames are ready at a steady rate.
+
+    Args:
+        refresh_rate: Display refresh rate in Hz, or 0 to pace emulation by audio playback.
+    """
+    GAME_BOY.SetDisplayRefreshRate(GBC, refresh_rate)
+
+
+def read_audio(buffer: ctypes.POINTER(ctypes.c_float), len: int) -> int:
+    """Fill the buffer with audio samples produced by the emulation thread without waiting on it.
+
+    Args:
+        buffer: Pointer to audio buffer to be filled.
+        len: Number of samples to read.
+
+    Returns:
+        Number of samples produced by the emulator. The rest of the buffer is filled with silence.
+    """
+    return GAME_BOY.ReadAudio(GBC, buffer, len)
 
 
-def set_frame_ready_callback(callback: ctypes.CFUNCTYPE(None)):
-    """Set the callback function used to render the frame buffer whenever it's full.
+def run_frames(num_frames: int) -> int:
+    """Run the Game Boy as fast as possible without producing audio.
 
     Args:
-        callback: Callback function for rendering.
+        num_frames: Number of frames to run.
+
+    Returns:
+        Number of frames run.
+    """
+    return GAME_BOY.RunFrames(GBC, num_frames)
+
+
+def run_until(cycle: int) -> int:
+    """Run the Game Boy as fast as possible without producing audio until it's run a total number of machine cycles.
+
+    Args:
+        cycle: Total number of machine cycles since power on to run to.
+
+    Returns:
+        Number of frames completed.
     """
-    GAME_BOY.SetFrameReadyCallback(callback)
+    return GAME_BOY.RunUntil(GBC, cycle)
+
+
+def get_cycle_count() -> int:
+    """Get the number of machine cycles run since power on."""
+    return GAME_BOY.GetCycleCount(GBC)
+
+
+def set_audio_decimation(factor: int):
+    """Only mix one of every few audio samples, to keep audio cheap when running faster than real time.
+
+    Args:
+        factor: Keep one of every factor samples. 1 keeps every sample.
+    """
+    GAME_BOY.SetAudioDecimation(GBC, factor)
 
 
 def power_off():
     """Turn off Game Boy. If the current game supports battery-backed saves, create a save file."""
-    GAME_BOY.PowerOff()
+    GAME_BOY.PowerOff(GBC)
 
 
-def get_frame_buffer() -> bytes:
-    """Get a bytes representation of the frame buffer.
+def acquire_frame() -> int:
+    """Get the most recently finished frame without copying it. It won't change until release_frame is called.
 
     Returns:
-        Frame buffer array.
+        Address of WIDTH * HEIGHT pixels in the current pixel format.
     """
-    return bytes(FRAME_BUFFER)
+    return GAME_BOY.AcquireFrame(GBC)
+
+
+def release_frame():
+    """Finish reading the frame returned by acquire_frame."""
+    GAME_BOY.ReleaseFrame(GBC)
 
 
 def change_emulation_speed(multiplier: float):
@@ -152,7 +273,7 @@ def change_emulation_speed(multiplier: float):
     Args:
         multiplier: Multiplier to alter clock speed by.
     """
-    GAME_BOY.SetClockMultiplier(ctypes.c_float(multiplier))
+    GAME_BOY.SetClockMultiplier(GBC, ctypes.c_float(multiplier))
 
 
 def create_save_state(save_state_path: Path):
@@ -162,7 +283,7 @@ def create_save_state(save_state_path: Path):
         save_state_path: Path to save state to.
     """
     save_state_path_buffer = ctypes.create_string_buffer(str.encode(str(save_state_path.absolute())))
-    GAME_BOY.CreateSaveState(save_state_path_buffer)
+    GAME_BOY.CreateSaveState(GBC, save_state_path_buffer)
 
 
 def load_save_state(save_state_path: Path):
@@ -172,7 +293,7 @@ def load_save_state(save_state_path: Path):
         save_state_path: Path to load state from.
     """
     save_state_path_buffer = ctypes.create_string_buffer(str.encode(str(save_state_path.absolute())))
-    GAME_BOY.LoadSaveState(save_state_path_buffer)
+    GAME_BOY.LoadSaveState(GBC, save_state_path_buffer)
 
 
 def enable_sound_channel(channel: int, enabled: bool):
@@ -182,7 +303,7 @@ def enable_sound_channel(channel: int, enabled: bool):
         channel: Channel number to enable/disable (between 1-4).
         enabled: True to enable channel, False to disable it.
     """
-    GAME_BOY.EnableSoundChannel(ctypes.c_int(channel), ctypes.c_bool(enabled))
+    GAME_BOY.EnableSoundChannel(GBC, ctypes.c_int(channel), ctypes.c_bool(enabled))
 
 
 def set_mono_audio(mono_audio: bool):
@@ -191,7 +312,7 @@ def set_mono_audio(mono_audio: bool):
     Args:
         mono_audio: True to use mono audio, False for stereo.
     """
-    GAME_BOY.SetMonoAudio(ctypes.c_bool(mono_audio))
+    GAME_BOY.SetMonoAudio(GBC, ctypes.c_bool(mono_audio))
 
 
 def set_volume(volume: float):
@@ -200,7 +321,7 @@ def set_volume(volume: float):
     Args:
         volume: Output level (between 0.0 and 1.0).
     """
-    GAME_BOY.SetVolume(ctypes.c_float(volume))
+    GAME_BOY.SetVolume(GBC, ctypes.c_float(volume))
 
 
 def set_sample_rate(rate: int):
@@ -209,7 +330,7 @@ def set_sample_rate(rate: int):
     Args:
         rate: Sample frequency in Hz.
     """
-    GAME_BOY.SetSampleRate(ctypes.c_int(rate))
+    GAME_BOY.SetSampleRate(GBC, ctypes.c_int(rate))
 
 
 def prefer_dmg_colors(use_dmg_colors: bool):
@@ -218,7 +339,7 @@ def prefer_dmg_colors(use_dmg_colors: bool):
     Args:
         use_dmg_colors: If True, use custom palettes.
     """
-    GAME_BOY.PreferDmgColors(ctypes.c_bool(use_dmg_colors))
+    GAME_BOY.PreferDmgColors(GBC, ctypes.c_bool(use_dmg_colors))
 
 
 def use_individual_palettes(individual_palettes: bool):
@@ -226,7 +347,7 @@ def use_individual_palettes(individual_palettes: bool):
 
     Args:
         individual_palettes: True if pixel sources should use their own palettes, False if they should all use the same palette."""
-    GAME_BOY.UseIndividualPalettes(ctypes.c_bool(individual_palettes))
+    GAME_BOY.UseIndividualPalettes(GBC, ctypes.c_bool(individual_palettes))
 
 
 def set_custom_palette(index: int, data: List[int]):
@@ -242,4 +363,80 @@ def set_custom_palette(index: int, data: List[int]):
         data: List of 12 0-255 rgb values that define 4 colors.
     """
     arr = (ctypes.c_uint8 * len(data))(*data)
-    GAME_BOY.SetCustomPalette(ctypes.c_uint8(index), arr)
+    GAME_BOY.SetCustomPalette(GBC, ctypes.c_uint8(index), arr)
+
+
+def set_instruction_stepping(enabled: bool):
+    """Toggle whether the CPU may run whole instructions ahead of the rest of the system when it's safe to do so.
+
+    Args:
+        enabled: True to allow instruction stepping, False to clock every component each M-cycle.
+    """
+    GAME_BOY.SetInstructionStepping(GBC, ctypes.c_bool(enabled))
+
+
+def set_scanline_renderer(enabled: bool):
+    """Toggle whether the PPU draws each scanline in one go instead of running its pixel FIFO every dot.
+
+    Args:
+        enabled: True to use the scanline renderer, False to always use the pixel FIFO.
+    """
+    GAME_BOY.SetScanlineRenderer(GBC, ctypes.c_bool(enabled))
+
+
+def set_pixel_format(pixel_format: int):
+    """Choose how pixels are written to frames.
+
+    Args:
+        pixel_format: One of the PIXEL_FORMAT constants.
+    """
+    GAME_BOY.SetPixelFormat(GBC, pixel_format)
+
+
+def get_palette_table() -> List[int]:
+    """Get the colors that PIXEL_FORMAT_INDEXED8 pixels refer to.
+
+    Returns:
+        64 RGB555 colors. For GBC games, 8 background palettes followed by 8 sprite palettes of 4 colors each. For GB games,
+        the first 4 are the color of each shade.
+    """
+    table = (ctypes.c_uint16 * 64)()
+    GAME_BOY.GetPaletteTable(GBC, table)
+    return list(table)
+
+
+def set_frame_skip(frames_to_skip: int):
+    """Skip drawing frames to save time. Emulation timing is unaffected.
+
+    Args:
+        frames_to_skip: Number of frames to skip after each drawn frame. 0 draws every frame.
+    """
+    GAME_BOY.SetFrameSkip(GBC, frames_to_skip)
+
+
+def run_batch(jobs: List[dict], num_threads: int = 0) -> List[dict]:
+    """Run many games headlessly across a pool of worker threads.
+
+    Args:
+        jobs: List of jobs. Each job is a dict with "rom_path" and "frames", and optionally "save_state_path",
+            "input_script_path", and "ram_dump_path".
+        num_threads: Number of worker threads. If 0, use one per hardware thread.
+
+    Returns:
+        Result of each job in the same order as jobs, as dicts with "success", "frames_run", "cycles_run", and "frame_hash".
+    """
+    def encode(path):
+        return str.encode(str(path)) if path else None
+
+    job_array = (BatchJob * len(jobs))()
+    result_array = (BatchResult * len(jobs))()
+
+    for i, job in enumerate(jobs):
+        job_array[i] = BatchJob(encode(job["rom_path"]),
+                                encode(job.get("save_state_path")),
+                                encode(job.get("input_script_path")),
+                                encode(job.get("ram_dump_path")),
+                                job["frames"])
+
+    GAME_BOY.RunBatch(job_array, result_array, len(jobs), num_threads)
+    return [{name: getattr(result, name) for name, _ in BatchResult._fields_} for result in result_array]
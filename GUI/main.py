@@ -19,14 +19,15 @@ class Refresher(QtCore.QObject):
         self.trigger.connect(MAIN_WINDOW.refresh_screen)
         self.trigger.emit()
 
-@ctypes.CFUNCTYPE(None)
-def refresh_screen_callback():
+@ctypes.CFUNCTYPE(None, ctypes.c_void_p)
+def refresh_screen_callback(user_data):
     Refresher()
 
 def main() -> int:
     global MAIN_WINDOW
     config_path = Path(__file__).resolve().parents[0]
     game_boy.initialize_game_boy(refresh_screen_callback)
+    game_boy.set_pixel_format(game_boy.PIXEL_FORMAT_XRGB8888)
     game_boy.set_sample_rate(44100)
     sdl_audio.initialize_sdl_audio(44100)
     config.load_config(config_path)
@@ -38,6 +39,7 @@ def main() -> int:
 
     app = QtWidgets.QApplication([])
     MAIN_WINDOW = MainWindow(icon_directory)
+    game_boy.set_display_refresh_rate(app.primaryScreen().refreshRate())
 
     sdl_audio.unlock_audio()
     val = app.exec()
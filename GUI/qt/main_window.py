@@ -4,7 +4,7 @@ from functools import partial
 from pathlib import Path
 from typing import Set
 
-from PyQt6 import QtCore, QtGui, QtWidgets
+from PyQt6 import QtCore, QtGui, QtWidgets, sip
 
 import config.config as config
 import controller.controller as controller
@@ -213,12 +213,15 @@ class MainWindow(QtWidgets.QMainWindow):
         self.frame_counter += 1
         self._update_joypad()
 
-        image = QtGui.QImage(game_boy.get_frame_buffer(),
+        # The image wraps the library's frame in place, which stays untouched until it's released.
+        image = QtGui.QImage(sip.voidptr(game_boy.acquire_frame()),
                              WIDTH,
                              HEIGHT,
-                             QtGui.QImage.Format.Format_RGB888)
+                             WIDTH * 4,
+                             QtGui.QImage.Format.Format_RGB32)
 
         self.lcd.setPixmap(QtGui.QPixmap.fromImage(image).scaled(self.lcd.width(), self.lcd.height()))
+        game_boy.release_frame()
 
 
     def _update_fps_counter(self):
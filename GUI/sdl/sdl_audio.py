@@ -2,7 +2,7 @@ import ctypes
 import game_boy.game_boy as game_boy
 import sdl2
 
-AUDIO_BUFFER_SIZE = 512
+AUDIO_BUFFER_SIZE = 256
 AUDIO_DEVICE: int = None
 
 @ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(sdl2.Uint8), ctypes.c_int)
@@ -16,7 +16,7 @@ def audio_callback(userdata, stream, len):
     """
     buffer = ctypes.cast(stream, ctypes.POINTER(ctypes.c_float))
     num_samples = (len // ctypes.sizeof(ctypes.c_float))
-    game_boy.collect_audio_samples(buffer, num_samples)
+    game_boy.read_audio(buffer, num_samples)
 
 def initialize_sdl_audio(sample_rate: int):
     """Set up SDL audio for 2 channels of 32-bit floating point PCM samples at the desired sample rate.
@@ -35,21 +35,23 @@ def initialize_sdl_audio(sample_rate: int):
     AUDIO_DEVICE = sdl2.SDL_OpenAudioDevice(None, 0, audio_spec, None, 0)
 
 def lock_audio():
-    """Stop audio playback. This pauses emulation."""
+    """Stop audio playback and pause emulation."""
     global AUDIO_DEVICE
     sdl2.SDL_LockAudioDevice(AUDIO_DEVICE)
     sdl2.SDL_PauseAudioDevice(AUDIO_DEVICE, 1)
-    sdl2.SDL_Delay(20)
+    game_boy.stop_emulation()
 
 def unlock_audio():
-    """Resume audio playback. This unpauses emulation."""
+    """Resume audio playback and emulation."""
     global AUDIO_DEVICE
+    game_boy.start_emulation()
     sdl2.SDL_UnlockAudioDevice(AUDIO_DEVICE)
     sdl2.SDL_PauseAudioDevice(AUDIO_DEVICE, 0)
 
 def destroy_audio_device():
     """Destroy the specified audio device."""
     global AUDIO_DEVICE
+    game_boy.stop_emulation()
     sdl2.SDL_UnlockAudioDevice(AUDIO_DEVICE)
     sdl2.SDL_CloseAudioDevice(AUDIO_DEVICE)
 
@@ -0,0 +1,89 @@
+#include "Benchmark.hpp"
+#include <APU.hpp>
+#include <GBC.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr int FRAMES_PER_RUN = 10;
+static constexpr int SAMPLE_RATE = 44100;
+
+// Stereo samples requested per frame, matching what the audio callback asks for at 60 frames per second.
+static constexpr int SAMPLES_PER_FRAME = 2 * (SAMPLE_RATE / 60);
+
+/// @brief APU register writes that start all four channels playing continuously.
+static std::vector<std::pair<uint8_t, uint8_t>> const CHANNEL_SETUP = {
+    {0x26, 0x80},  // NR52: APU on
+    {0x24, 0x77},  // NR50: Full volume
+    {0x25, 0xFF},  // NR51: Every channel to both sides
+    {0x10, 0x00},  // NR10: No sweep
+    {0x11, 0x80},  // NR11: 50% duty
+    {0x12, 0xF0},  // NR12: Full volume, no envelope
+    {0x13, 0x83},  // NR13
+    {0x14, 0x87},  // NR14: Trigger
+    {0x16, 0x40},  // NR21: 25% duty
+    {0x17, 0xF0},  // NR22: Full volume, no envelope
+    {0x18, 0x40},  // NR23
+    {0x19, 0x86},  // NR24: Trigger
+    {0x1A, 0x80},  // NR30: DAC on
+    {0x1C, 0x20},  // NR32: Full volume
+    {0x1D, 0x00},  // NR33
+    {0x1E, 0x87},  // NR34: Trigger
+    {0x21, 0xF0},  // NR42: Full volume, no envelope
+    {0x22, 0x34},  // NR43
+    {0x23, 0x80},  // NR44: Trigger
+};
+
+static void AddApuBenchmark(std::vector<Benchmark>& benchmarks, bool drain)
+{
+    std::string name = drain ? "apu/clock_and_drain" : "apu/clock";
+
+    benchmarks.push_back({name, "frame", [=]() -> BenchmarkRun {
+        auto apu = std::make_shared<APU>();
+        apu->PowerOn(true);
+        apu->SetSampleRate(SAMPLE_RATE);
+
+        for (uint_fast8_t i = 0; i < 0x10; ++i)
+        {
+            apu->Write(0x30 + i, (i * 0x1F) & 0xFF);  // Wave RAM
+        }
+
+        for (auto [ioAddr, data] : CHANNEL_SETUP)
+        {
+            apu->Write(ioAddr, data);
+        }
+
+        auto buffer = std::make_shared<std::vector<float>>(SAMPLES_PER_FRAME);
+
+        return [apu, buffer, drain]() -> uint64_t {
+            for (int frame = 0; frame < FRAMES_PER_RUN; ++frame)
+            {
+                for (int i = 0; i < GBC_M_CYCLES_PER_FRAME; ++i)
+                {
+                    apu->Clock();
+                }
+
+                apu->AdvanceDIV(GBC_M_CYCLES_PER_FRAME, false);
+
+                if (drain)
+                {
+                    apu->DrainSampleBuffer(buffer->data(), buffer->size());
+                }
+                else
+                {
+                    apu->DiscardSamples();
+                }
+            }
+
+            Consume(static_cast<uint64_t>((*buffer)[0] * 1000));
+            return FRAMES_PER_RUN;
+        };
+    }});
+}
+
+void RegisterApuBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+    AddApuBenchmark(benchmarks, false);
+    AddApuBenchmark(benchmarks, true);
+}
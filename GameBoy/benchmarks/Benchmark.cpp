@@ -0,0 +1,295 @@
+#include "Benchmark.hpp"
+#include <GameBoy.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr size_t FRAME_BUFFER_SIZE = 160 * 144 * 3;
+static constexpr size_t ROM_SIZE = 0x10000;
+static constexpr uint16_t PROGRAM_START = 0x0150;
+
+static volatile uint64_t sink;
+
+void Consume(uint64_t const value)
+{
+    sink = sink + value;
+}
+
+std::filesystem::path WriteTestRom(std::string const& name, std::vector<uint8_t> const& program, uint8_t const cartridgeType)
+{
+    std::vector<uint8_t> rom(ROM_SIZE);
+
+    for (size_t i = 0x4000; i < ROM_SIZE; ++i)
+    {
+        rom[i] = (i * 31) & 0xFF;
+    }
+
+    // Entry point: NOP; JP $0150
+    rom[0x0100] = 0x00;
+    rom[0x0101] = 0xC3;
+    rom[0x0102] = PROGRAM_START & 0xFF;
+    rom[0x0103] = PROGRAM_START >> 8;
+
+    for (size_t i = 0; (i < name.size()) && (i < 15); ++i)
+    {
+        rom[0x0134 + i] = std::toupper(name[i]);
+    }
+
+    rom[0x0147] = cartridgeType;
+    rom[0x0148] = 0x01;  // 64KB ROM
+    rom[0x0149] = 0x03;  // 32KB RAM
+
+    uint8_t checksum = 0;
+
+    for (size_t i = 0x0134; i < 0x014D; ++i)
+    {
+        checksum = checksum - rom[i] - 1;
+    }
+
+    rom[0x014D] = checksum;
+    std::copy(program.begin(), program.end(), rom.begin() + PROGRAM_START);
+
+    auto romPath = std::filesystem::temp_directory_path() / ("gbc-bench-" + name + ".gb");
+    std::ofstream out(romPath, std::ios::binary);
+    out.write(reinterpret_cast<char const*>(rom.data()), rom.size());
+    return romPath;
+}
+
+std::unique_ptr<TestSystem> StartTestSystem(std::string const& name,
+                                            std::vector<uint8_t> const& program,
+                                            uint8_t const cartridgeType)
+{
+    auto system = std::make_unique<TestSystem>();
+    system->frameBuffer.resize(FRAME_BUFFER_SIZE);
+    system->gb = std::make_unique<GameBoy>();
+    system->gb->Initialize(system->frameBuffer.data());
+    char romName[17];
+
+    if (!system->gb->InsertCartridge(WriteTestRom(name, program, cartridgeType), "", romName))
+    {
+        std::cerr << "Failed to load synthetic ROM for " << name << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    system->gb->PowerOn("");
+    return system;
+}
+
+/// @brief Timing of every repetition of a benchmark.
+struct BenchmarkResult
+{
+    std::string name;
+    std::string itemName;
+    uint64_t itemsPerRun;
+    std::vector<double> nsPerItem;  // One entry per repetition
+};
+
+/// @brief Escape a string for use in JSON. Benchmark names are plain ASCII, so only quotes and backslashes need handling.
+static std::string JsonString(std::string const& str)
+{
+    std::string escaped = "\"";
+
+    for (char c : str)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            escaped += '\\';
+        }
+
+        escaped += c;
+    }
+
+    return escaped + "\"";
+}
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t const mid = values.size() / 2;
+    return (values.size() % 2) ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+static void WriteJson(std::ostream& out, std::vector<BenchmarkResult> const& results, int repetitions)
+{
+    std::time_t const now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+#if defined(__clang__)
+    std::string const compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    std::string const compiler = "gcc " __VERSION__;
+#else
+    std::string const compiler = "unknown";
+#endif
+
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": " << JsonString(date) << ",\n";
+    out << "    \"compiler\": " << JsonString(compiler) << ",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"repetitions\": " << repetitions << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto const& result = results[i];
+        auto const& times = result.nsPerItem;
+        double const median = Median(times);
+        double mean = 0;
+
+        for (double ns : times)
+        {
+            mean += ns;
+        }
+
+        mean /= times.size();
+        double variance = 0;
+
+        for (double ns : times)
+        {
+            variance += (ns - mean) * (ns - mean);
+        }
+
+        double const stddev = std::sqrt(variance / times.size());
+
+        out << ((i == 0) ? "\n" : ",\n");
+        out << "    {\n";
+        out << "      \"name\": " << JsonString(result.name) << ",\n";
+        out << "      \"item\": " << JsonString(result.itemName) << ",\n";
+        out << "      \"items_per_run\": " << result.itemsPerRun << ",\n";
+        out << "      \"time_unit\": \"ns\",\n";
+        out << "      \"median\": " << median << ",\n";
+        out << "      \"mean\": " << mean << ",\n";
+        out << "      \"min\": " << *std::min_element(times.begin(), times.end()) << ",\n";
+        out << "      \"max\": " << *std::max_element(times.begin(), times.end()) << ",\n";
+        out << "      \"stddev\": " << stddev << ",\n";
+        out << "      \"items_per_second\": " << (1e9 / median) << "\n";
+        out << "    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+static void PrintUsage(char const* program)
+{
+    std::printf("Usage: %s [options]\n"
+                "\n"
+                "Run micro-benchmarks of the emulator's components and report the time per item processed as JSON.\n"
+                "\n"
+                "Options:\n"
+                "  --filter TEXT      Only run benchmarks whose name contains TEXT\n"
+                "  --repetitions N    Number of timed runs of each benchmark (default 10)\n"
+                "  --out PATH         Write JSON results to PATH instead of stdout\n"
+                "  --list             List benchmark names and exit\n",
+                program);
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::filesystem::path outPath;
+    int repetitions = 10;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1) < argc;
+
+        if (arg == "--list")
+        {
+            list = true;
+        }
+        else if ((arg == "--filter") && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if ((arg == "--repetitions") && hasValue)
+        {
+            repetitions = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if ((arg == "--out") && hasValue)
+        {
+            outPath = argv[++i];
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return ((arg == "-h") || (arg == "--help")) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Benchmark> benchmarks;
+    RegisterCpuBenchmarks(benchmarks);
+    RegisterPpuBenchmarks(benchmarks);
+    RegisterApuBenchmarks(benchmarks);
+    RegisterBusBenchmarks(benchmarks);
+    RegisterSerializeBenchmarks(benchmarks);
+
+    std::vector<BenchmarkResult> results;
+
+    for (auto const& benchmark : benchmarks)
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        else if (list)
+        {
+            std::cout << benchmark.name << "\n";
+            continue;
+        }
+
+        BenchmarkRun run = benchmark.setup();
+        BenchmarkResult result{benchmark.name, benchmark.itemName, run(), {}};  // First run warms up caches and isn't timed
+
+        for (int i = 0; i < repetitions; ++i)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            uint64_t const items = run();
+            auto const elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            result.nsPerItem.push_back(elapsed / items);
+        }
+
+        std::fprintf(stderr, "%-40s %12.2f ns/%s\n", result.name.c_str(), Median(result.nsPerItem), result.itemName.c_str());
+        results.push_back(std::move(result));
+    }
+
+    if (list)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (outPath.empty())
+    {
+        WriteJson(std::cout, results, repetitions);
+    }
+    else
+    {
+        std::ofstream out(outPath);
+
+        if (out.fail())
+        {
+            std::fprintf(stderr, "Failed to open %s\n", outPath.string().c_str());
+            return EXIT_FAILURE;
+        }
+
+        WriteJson(out, results, repetitions);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GameBoy;
+
+/// @brief Do the work being measured once.
+/// @return Number of items (M-cycles, frames, accesses, ...) processed.
+using BenchmarkRun = std::function<uint64_t()>;
+
+/// @brief A single named benchmark.
+struct Benchmark
+{
+    std::string name;
+    std::string itemName;                 // What one item processed by a run is, e.g. "M-cycle" or "frame"
+    std::function<BenchmarkRun()> setup;  // Build the state to operate on and return the work to time. Not timed.
+};
+
+/// @brief Keep the compiler from optimizing away a computed value.
+/// @param value Value to consume.
+void Consume(uint64_t value);
+
+// Benchmarks for each component.
+
+void RegisterCpuBenchmarks(std::vector<Benchmark>& benchmarks);
+void RegisterPpuBenchmarks(std::vector<Benchmark>& benchmarks);
+void RegisterApuBenchmarks(std::vector<Benchmark>& benchmarks);
+void RegisterBusBenchmarks(std::vector<Benchmark>& benchmarks);
+void RegisterSerializeBenchmarks(std::vector<Benchmark>& benchmarks);
+
+// Synthetic cartridges.
+
+// Cartridge types, as stored in the cartridge header at $0147
+static constexpr uint8_t CARTRIDGE_MBC1_RAM = 0x02;
+static constexpr uint8_t CARTRIDGE_MBC5_RAM = 0x1A;
+
+/// @brief A GameBoy running a synthetic cartridge, along with the frame buffer it draws to.
+struct TestSystem
+{
+    std::vector<uint8_t> frameBuffer;
+    std::unique_ptr<GameBoy> gb;
+};
+
+/// @brief Write a 64KB cartridge with 32KB of RAM to the temp directory. The entry point jumps to the program at $0150, and the
+///        switchable ROM banks are filled with a fixed pattern.
+/// @param name Name used for the file and cartridge title.
+/// @param program Code to place at $0150.
+/// @param cartridgeType Memory bank controller, one of the CARTRIDGE constants.
+/// @return Path to the ROM file.
+std::filesystem::path WriteTestRom(std::string const& name,
+                                   std::vector<uint8_t> const& program,
+                                   uint8_t cartridgeType = CARTRIDGE_MBC5_RAM);
+
+/// @brief Power on a GameBoy running a synthetic cartridge, skipping the boot ROM.
+/// @param name Name used for the file and cartridge title.
+/// @param program Code to place at $0150.
+/// @param cartridgeType Memory bank controller, one of the CARTRIDGE constants.
+/// @return The running system.
+std::unique_ptr<TestSystem> StartTestSystem(std::string const& name,
+                                            std::vector<uint8_t> const& program,
+                                            uint8_t cartridgeType = CARTRIDGE_MBC5_RAM);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <GameBoy.hpp>
+#include <PPU.hpp>
+#include <cstdint>
+
+/// @brief Lets benchmarks time private functions of the emulator's components directly. Components with such functions declare
+///        this a friend.
+struct BenchmarkAccess
+{
+    static uint8_t Read(GameBoy& gb, uint16_t addr) { return gb.Read(addr); }
+    static void Write(GameBoy& gb, uint16_t addr, uint8_t data) { gb.Write(addr, data); }
+    static void OamScan(PPU& ppu) { ppu.OamScan(); }
+};
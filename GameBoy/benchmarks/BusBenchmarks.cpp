@@ -0,0 +1,173 @@
+#include "Benchmark.hpp"
+#include "BenchmarkAccess.hpp"
+#include <GameBoy.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr int ACCESSES_PER_RUN = 1 << 20;
+
+// JR -2: spin forever. The system is never clocked, this just gives the cartridge something valid to run.
+static std::vector<uint8_t> const IDLE_PROGRAM = {0x18, 0xFE};
+
+/// @brief Region of the address space to sweep over.
+struct Region
+{
+    char const* name;
+    uint16_t start;
+    uint16_t size;
+};
+
+static std::vector<Region> const READ_REGIONS = {
+    {"rom0", 0x0000, 0x4000},
+    {"romx", 0x4000, 0x4000},
+    {"vram", 0x8000, 0x2000},
+    {"sram", 0xA000, 0x2000},
+    {"wram0", 0xC000, 0x1000},
+    {"wramx", 0xD000, 0x1000},
+    {"echo", 0xE000, 0x1E00},
+    {"oam", 0xFE00, 0x00A0},
+    {"io", 0xFF00, 0x0080},
+    {"hram", 0xFF80, 0x007F},
+};
+
+// Writes to ROM go to the MBC's registers and most I/O writes have side effects, so they're benchmarked separately.
+static std::vector<Region> const WRITE_REGIONS = {
+    {"vram", 0x8000, 0x2000},
+    {"sram", 0xA000, 0x2000},
+    {"wram0", 0xC000, 0x1000},
+    {"wramx", 0xD000, 0x1000},
+    {"echo", 0xE000, 0x1E00},
+    {"oam", 0xFE00, 0x00A0},
+    {"hram", 0xFF80, 0x007F},
+};
+
+// I/O registers whose writes only latch a value for the PPU: SCY, SCX, BGP, OBP0, OBP1, WY, and WX.
+static std::vector<uint16_t> const IO_WRITE_REGISTERS = {0xFF42, 0xFF43, 0xFF47, 0xFF48, 0xFF49, 0xFF4A, 0xFF4B};
+
+/// @brief Memory bank controller to switch and read ROM banks through.
+struct Mbc
+{
+    char const* name;
+    uint8_t cartridgeType;
+};
+
+static std::vector<Mbc> const ROM_BANK_MBCS = {
+    {"mbc1", CARTRIDGE_MBC1_RAM},
+    {"mbc5", CARTRIDGE_MBC5_RAM},
+};
+
+// Synthetic cartridges have 4 ROM banks, so these are the lowest and highest switchable ones.
+static std::vector<uint8_t> const ROM_BANKS = {1, 3};
+
+/// @brief Power on a system with cartridge RAM enabled and the second ROM bank mapped.
+static std::shared_ptr<TestSystem> StartBusSystem()
+{
+    std::shared_ptr<TestSystem> system = StartTestSystem("bus", IDLE_PROGRAM);
+    BenchmarkAccess::Write(*system->gb, 0x0000, 0x0A);  // Enable RAM
+    BenchmarkAccess::Write(*system->gb, 0x2000, 0x02);  // ROM bank 2
+    return system;
+}
+
+void RegisterBusBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+    for (auto const& region : READ_REGIONS)
+    {
+        benchmarks.push_back({std::string("bus/read/") + region.name, "access", [region]() -> BenchmarkRun {
+            auto system = StartBusSystem();
+
+            return [system, region]() -> uint64_t {
+                GameBoy& gb = *system->gb;
+                uint64_t sum = 0;
+
+                for (int i = 0; i < ACCESSES_PER_RUN; ++i)
+                {
+                    sum += BenchmarkAccess::Read(gb, region.start + (i % region.size));
+                }
+
+                Consume(sum);
+                return ACCESSES_PER_RUN;
+            };
+        }});
+    }
+
+    for (auto const& region : WRITE_REGIONS)
+    {
+        benchmarks.push_back({std::string("bus/write/") + region.name, "access", [region]() -> BenchmarkRun {
+            auto system = StartBusSystem();
+
+            return [system, region]() -> uint64_t {
+                GameBoy& gb = *system->gb;
+
+                for (int i = 0; i < ACCESSES_PER_RUN; ++i)
+                {
+                    BenchmarkAccess::Write(gb, region.start + (i % region.size), i & 0xFF);
+                }
+
+                return ACCESSES_PER_RUN;
+            };
+        }});
+    }
+
+    for (auto const& mbc : ROM_BANK_MBCS)
+    {
+        for (uint8_t const bank : ROM_BANKS)
+        {
+            std::string const name = std::string("bus/read/") + mbc.name + "/rom_bank" + std::to_string(bank);
+
+            benchmarks.push_back({name, "access", [mbc, bank]() -> BenchmarkRun {
+                std::shared_ptr<TestSystem> system =
+                    StartTestSystem(std::string("bus_") + mbc.name, IDLE_PROGRAM, mbc.cartridgeType);
+                BenchmarkAccess::Write(*system->gb, 0x2000, bank);
+
+                return [system]() -> uint64_t {
+                    GameBoy& gb = *system->gb;
+                    uint64_t sum = 0;
+
+                    for (int i = 0; i < ACCESSES_PER_RUN; ++i)
+                    {
+                        sum += BenchmarkAccess::Read(gb, 0x4000 + (i % 0x4000));
+                    }
+
+                    Consume(sum);
+                    return ACCESSES_PER_RUN;
+                };
+            }});
+        }
+    }
+
+    benchmarks.push_back({"bus/write/io", "access", []() -> BenchmarkRun {
+        auto system = StartBusSystem();
+
+        return [system]() -> uint64_t {
+            GameBoy& gb = *system->gb;
+
+            for (int i = 0; i < ACCESSES_PER_RUN; ++i)
+            {
+                BenchmarkAccess::Write(gb, IO_WRITE_REGISTERS[i % IO_WRITE_REGISTERS.size()], i & 0xFF);
+            }
+
+            return ACCESSES_PER_RUN;
+        };
+    }});
+
+    for (auto const& mbc : ROM_BANK_MBCS)
+    {
+        benchmarks.push_back({std::string("bus/write/") + mbc.name + "/rom_bank", "access", [mbc]() -> BenchmarkRun {
+            std::shared_ptr<TestSystem> system =
+                StartTestSystem(std::string("bus_") + mbc.name, IDLE_PROGRAM, mbc.cartridgeType);
+
+            return [system]() -> uint64_t {
+                GameBoy& gb = *system->gb;
+
+                for (int i = 0; i < ACCESSES_PER_RUN; ++i)
+                {
+                    BenchmarkAccess::Write(gb, 0x2000, (i & 0x03) | 0x01);
+                }
+
+                return ACCESSES_PER_RUN;
+            };
+        }});
+    }
+}
@@ -0,0 +1,151 @@
+#include "Benchmark.hpp"
+#include <GameBoy.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One second of emulated time at normal speed.
+static constexpr int M_CYCLES_PER_RUN = 1048576;
+
+// XOR A; LDH (LCDC),A; LDH (NR52),A; LDH (IE),A; DI
+// Turns off the LCD and APU and disables interrupts so that the CPU is the only component doing any real work.
+static std::vector<uint8_t> const PROLOGUE = {0xAF, 0xE0, 0x40, 0xE0, 0x26, 0xE0, 0xFF, 0xF3};
+
+/// @brief Build a program that runs the prologue, then setup once, then loops over body forever.
+static std::vector<uint8_t> LoopProgram(std::vector<uint8_t> const& setup, std::vector<uint8_t> const& body)
+{
+    std::vector<uint8_t> program = PROLOGUE;
+    program.insert(program.end(), setup.begin(), setup.end());
+    uint16_t const loopAddr = 0x0150 + program.size();
+    program.insert(program.end(), body.begin(), body.end());
+
+    // JP loop
+    program.push_back(0xC3);
+    program.push_back(loopAddr & 0xFF);
+    program.push_back(loopAddr >> 8);
+    return program;
+}
+
+// 8-bit arithmetic and logic on registers and immediates.
+static std::vector<uint8_t> const ALU_BODY = {
+    0x06, 0x13,  // LD B,$13
+    0x0E, 0x57,  // LD C,$57
+    0x80,        // ADD A,B
+    0xA9,        // XOR C
+    0x14,        // INC D
+    0x1D,        // DEC E
+    0xA4,        // AND H
+    0xB5,        // OR L
+    0xCE, 0x3C,  // ADC A,$3C
+    0xD6, 0x11,  // SUB $11
+    0xB8,        // CP B
+    0x07,        // RLCA
+    0x57,        // LD D,A
+    0x23,        // INC HL
+    0x0B,        // DEC BC
+    0x09,        // ADD HL,BC
+};
+
+// Copies between WRAM banks and HRAM.
+static std::vector<uint8_t> const LOAD_STORE_BODY = {
+    0x21, 0x00, 0xC0,  // LD HL,$C000
+    0x11, 0x00, 0xD0,  // LD DE,$D000
+    0x2A,              // LD A,(HL+)
+    0x12,              // LD (DE),A
+    0x13,              // INC DE
+    0xE0, 0x80,        // LDH ($80),A
+    0xF0, 0x81,        // LDH A,($81)
+    0x77,              // LD (HL),A
+    0x2A,              // LD A,(HL+)
+    0x12,              // LD (DE),A
+    0x13,              // INC DE
+    0xFA, 0x00, 0xC8,  // LD A,($C800)
+    0xEA, 0x00, 0xD8,  // LD ($D800),A
+    0x36, 0x5A,        // LD (HL),$5A
+    0x34,              // INC (HL)
+};
+
+// Calls, returns, stack operations, and conditional jumps. The subroutine follows the body and is reached through CALL.
+static std::vector<uint8_t> BranchBody(uint16_t subroutineAddr)
+{
+    return {
+        0xCD, static_cast<uint8_t>(subroutineAddr & 0xFF), static_cast<uint8_t>(subroutineAddr >> 8),  // CALL sub
+        0xC5,        // PUSH BC
+        0xD1,        // POP DE
+        0x18, 0x00,  // JR +0
+        0x3E, 0x04,  // LD A,$04
+        0x3D,        // DEC A  <-
+        0x20, 0xFD,  // JR NZ,-3
+        0xCA, static_cast<uint8_t>((subroutineAddr + 3) & 0xFF), static_cast<uint8_t>((subroutineAddr + 3) >> 8),  // JP Z,skip
+    };
+}
+
+// PUSH HL; POP HL; RET, followed by a JP back to the loop as the target of JP Z.
+static std::vector<uint8_t> const BRANCH_SUBROUTINE = {0xE5, 0xE1, 0xC9};
+
+// CB-prefixed bit operations, rotates, and shifts.
+static std::vector<uint8_t> const CB_SETUP = {0x21, 0x00, 0xC1};  // LD HL,$C100
+
+static std::vector<uint8_t> const CB_BODY = {
+    0xCB, 0x37,  // SWAP A
+    0xCB, 0x58,  // BIT 3,B
+    0xCB, 0xD1,  // SET 2,C
+    0xCB, 0xAA,  // RES 5,D
+    0xCB, 0x13,  // RL E
+    0xCB, 0x3C,  // SRL H
+    0xCB, 0x06,  // RLC (HL)
+    0xCB, 0xFE,  // SET 7,(HL)
+    0xCB, 0x46,  // BIT 0,(HL)
+    0xCB, 0x2F,  // SRA A
+};
+
+/// @brief Build a program that loops over the branch benchmark's body, with the subroutine placed right after the loop.
+static std::vector<uint8_t> BranchProgram()
+{
+    // Body and loop JP are laid out after the prologue, so the subroutine's address depends on the body's length.
+    uint16_t const bodySize = BranchBody(0).size();
+    uint16_t const subroutineAddr = 0x0150 + PROLOGUE.size() + bodySize + 3;
+    auto program = LoopProgram({}, BranchBody(subroutineAddr));
+    program.insert(program.end(), BRANCH_SUBROUTINE.begin(), BRANCH_SUBROUTINE.end());
+
+    // Target of JP Z: jump back to the start of the loop.
+    uint16_t const loopAddr = 0x0150 + PROLOGUE.size();
+    program.push_back(0xC3);
+    program.push_back(loopAddr & 0xFF);
+    program.push_back(loopAddr >> 8);
+    return program;
+}
+
+static void AddCpuBenchmark(std::vector<Benchmark>& benchmarks, std::string const& name, std::vector<uint8_t> const& program)
+{
+    for (bool const instructionStepping : {true, false})
+    {
+        std::string fullName = "cpu/" + name + (instructionStepping ? "" : "/per_mcycle");
+
+        benchmarks.push_back({fullName, "M-cycle", [=]() -> BenchmarkRun {
+            std::shared_ptr<TestSystem> system = StartTestSystem(name, program);
+            system->gb->SetInstructionStepping(instructionStepping);
+
+            return [system]() -> uint64_t {
+                int cyclesRemaining = M_CYCLES_PER_RUN;
+
+                while (cyclesRemaining > 0)
+                {
+                    cyclesRemaining -= system->gb->Clock(cyclesRemaining).first;
+                }
+
+                system->gb->DiscardSamples();
+                return M_CYCLES_PER_RUN;
+            };
+        }});
+    }
+}
+
+void RegisterCpuBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+    AddCpuBenchmark(benchmarks, "alu", LoopProgram({}, ALU_BODY));
+    AddCpuBenchmark(benchmarks, "load_store", LoopProgram({}, LOAD_STORE_BODY));
+    AddCpuBenchmark(benchmarks, "branch", BranchProgram());
+    AddCpuBenchmark(benchmarks, "cb", LoopProgram(CB_SETUP, CB_BODY));
+}
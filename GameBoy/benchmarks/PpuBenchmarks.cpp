@@ -0,0 +1,183 @@
+#include "Benchmark.hpp"
+#include "BenchmarkAccess.hpp"
+#include <PPU.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr int DOTS_PER_FRAME = 70224;
+static constexpr int FRAMES_PER_RUN = 10;
+static constexpr size_t FRAME_BUFFER_SIZE = 160 * 144 * 3;
+static constexpr int OAM_SCANS_PER_RUN = 1 << 16;
+
+/// @brief A PPU on its own, along with the frame buffer it draws to.
+struct PpuSystem
+{
+    PpuSystem(bool cgb) : cgbMode(cgb), ppu(cgbMode), frameBuffer(FRAME_BUFFER_SIZE) {}
+
+    bool cgbMode;
+    PPU ppu;
+    std::vector<uint8_t> frameBuffer;
+};
+
+/// @brief Fill VRAM, OAM, and the palettes with a scene that exercises every part of the renderer that's enabled.
+static void LoadScene(PpuSystem& system, bool spritesAndWindow)
+{
+    PPU& ppu = system.ppu;
+    ppu.Write(0xFF00 | IO::LCDC, 0x00);
+
+    for (uint_fast8_t bank = 0; bank < (system.cgbMode ? 2 : 1); ++bank)
+    {
+        ppu.Write(0xFF00 | IO::VBK, bank);
+
+        // Tile data
+        for (uint16_t addr = 0x8000; addr < 0x9800; ++addr)
+        {
+            ppu.Write(addr, ((addr * 73) >> 3) & 0xFF);
+        }
+
+        // Tile maps in bank 0, attributes (palette, VRAM bank, flips) in bank 1
+        for (uint16_t addr = 0x9800; addr < 0xA000; ++addr)
+        {
+            ppu.Write(addr, (bank == 0) ? (addr & 0xFF) : (((addr * 5) & 0x07) | ((addr & 0x03) << 5) | ((addr & 0x10) >> 1)));
+        }
+    }
+
+    ppu.Write(0xFF00 | IO::VBK, 0x00);
+
+    // CGB palettes, auto-incrementing through all of CRAM
+    ppu.Write(0xFF00 | IO::BCPS, 0x80);
+    ppu.Write(0xFF00 | IO::OCPS, 0x80);
+
+    for (uint_fast8_t i = 0; i < 0x40; ++i)
+    {
+        ppu.Write(0xFF00 | IO::BCPD, (i * 37) & 0xFF);
+        ppu.Write(0xFF00 | IO::OCPD, (i * 59) & 0xFF);
+    }
+
+    // DMG palettes
+    ppu.Write(0xFF00 | IO::BGP, 0xE4);
+    ppu.Write(0xFF00 | IO::OBP0, 0xD2);
+    ppu.Write(0xFF00 | IO::OBP1, 0x1B);
+
+    uint8_t lcdc = 0x91;  // LCD on, $8000 tile data, BG on
+
+    if (spritesAndWindow)
+    {
+        // Spread 40 sprites over the screen, up to 10 per line
+        for (uint_fast8_t i = 0; i < 40; ++i)
+        {
+            uint16_t const addr = 0xFE00 + (i * 4);
+            ppu.Write(addr, 16 + ((i * 37) % 144));
+            ppu.Write(addr + 1, 8 + ((i * 53) % 160));
+            ppu.Write(addr + 2, i);
+            ppu.Write(addr + 3, (i & 0x07) | ((i & 0x08) << 1) | ((i & 0x30) << 1) | ((i & 0x01) << 7));
+        }
+
+        ppu.Write(0xFF00 | IO::WY, 40);
+        ppu.Write(0xFF00 | IO::WX, 47);
+        lcdc |= 0x62;  // Window on with $9C00 tile map, sprites on
+    }
+
+    ppu.Write(0xFF00 | IO::SCX, 3);
+    ppu.Write(0xFF00 | IO::SCY, 5);
+    ppu.Write(0xFF00 | IO::LCDC, lcdc);
+}
+
+static void AddPpuBenchmark(std::vector<Benchmark>& benchmarks, bool cgb, bool spritesAndWindow, bool scanlineRenderer)
+{
+    std::string name = std::string("ppu/") + (cgb ? "cgb" : "dmg") + (spritesAndWindow ? "/bg_window_sprites" : "/bg") +
+                       (scanlineRenderer ? "/scanline" : "/fifo");
+
+    benchmarks.push_back({name, "frame", [=]() -> BenchmarkRun {
+        auto system = std::make_shared<PpuSystem>(cgb);
+        system->ppu.SetFrameBuffer(system->frameBuffer.data());
+        system->ppu.PowerOn(true);
+        system->ppu.SetScanlineRenderer(scanlineRenderer);
+        LoadScene(*system, spritesAndWindow);
+
+        return [system]() -> uint64_t {
+            PPU& ppu = system->ppu;
+
+            // Idle dots are skipped the same way GameBoy does when the PPU has nothing to do.
+            for (int frame = 0; frame < FRAMES_PER_RUN; ++frame)
+            {
+                int dot = 0;
+
+                while (dot < DOTS_PER_FRAME)
+                {
+                    ppu.Clock();
+                    ++dot;
+
+                    uint16_t const idleDots = std::min<int>(ppu.IdleDots(), DOTS_PER_FRAME - dot);
+                    ppu.SkipDots(idleDots);
+                    dot += idleDots;
+                }
+
+                ppu.FrameReady();
+                ppu.VBlank();
+            }
+
+            Consume(system->frameBuffer[FRAME_BUFFER_SIZE / 2]);
+            return FRAMES_PER_RUN;
+        };
+    }});
+}
+
+/// @brief Time the OAM scan at the start of a line on its own, with some number of the 40 sprites on that line.
+static void AddOamScanBenchmark(std::vector<Benchmark>& benchmarks, int visibleSprites)
+{
+    benchmarks.push_back({"ppu/oam_scan/" + std::to_string(visibleSprites), "line", [=]() -> BenchmarkRun {
+        auto system = std::make_shared<PpuSystem>(false);
+        system->ppu.SetFrameBuffer(system->frameBuffer.data());
+        system->ppu.PowerOn(true);
+
+        // With the LCD off, OAM is writable and LY stays at 0, so a sprite is on the scanned line if its Y position is 16.
+        // Visible sprites are spread evenly through OAM so that the scan has to look at every entry to find them.
+        PPU& ppu = system->ppu;
+        ppu.Write(0xFF00 | IO::LCDC, 0x00);
+        int const spacing = (visibleSprites > 0) ? (40 / visibleSprites) : 40;
+
+        for (int i = 0; i < 40; ++i)
+        {
+            uint16_t const addr = 0xFE00 + (i * 4);
+            bool const visible = ((i % spacing) == 0) && ((i / spacing) < visibleSprites);
+            ppu.Write(addr, visible ? 16 : 0);
+            ppu.Write(addr + 1, 8 + ((i * 53) % 160));
+            ppu.Write(addr + 2, i);
+            ppu.Write(addr + 3, 0x00);
+        }
+
+        return [system]() -> uint64_t {
+            PPU& ppu = system->ppu;
+
+            for (int i = 0; i < OAM_SCANS_PER_RUN; ++i)
+            {
+                BenchmarkAccess::OamScan(ppu);
+            }
+
+            return OAM_SCANS_PER_RUN;
+        };
+    }});
+}
+
+void RegisterPpuBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+    for (int const visibleSprites : {0, 10, 40})
+    {
+        AddOamScanBenchmark(benchmarks, visibleSprites);
+    }
+
+    for (bool const cgb : {false, true})
+    {
+        for (bool const spritesAndWindow : {false, true})
+        {
+            for (bool const scanlineRenderer : {false, true})
+            {
+                AddPpuBenchmark(benchmarks, cgb, spritesAndWindow, scanlineRenderer);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include "Benchmark.hpp"
+#include <GameBoy.hpp>
+#include <GBC.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+static constexpr int STATES_PER_RUN = 100;
+
+// JR -2: spin forever with the LCD left on.
+static std::vector<uint8_t> const IDLE_PROGRAM = {0x18, 0xFE};
+
+/// @brief Run a system until the end of its next frame, where it can be serialized.
+static std::shared_ptr<TestSystem> StartSerializableSystem()
+{
+    std::shared_ptr<TestSystem> system = StartTestSystem("serialize", IDLE_PROGRAM);
+
+    while (!system->gb->Clock(GBC_M_CYCLES_PER_FRAME).second || !system->gb->IsSerializable())
+    {
+    }
+
+    return system;
+}
+
+static std::filesystem::path SaveStatePath()
+{
+    return std::filesystem::temp_directory_path() / "gbc-bench-serialize.ss";
+}
+
+void RegisterSerializeBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+    benchmarks.push_back({"state/serialize", "state", []() -> BenchmarkRun {
+        auto system = StartSerializableSystem();
+        auto out = std::make_shared<std::ofstream>(SaveStatePath(), std::ios::binary);
+
+        return [system, out]() -> uint64_t {
+            for (int i = 0; i < STATES_PER_RUN; ++i)
+            {
+                out->seekp(0);
+                system->gb->Serialize(*out);
+            }
+
+            out->flush();
+            return STATES_PER_RUN;
+        };
+    }});
+
+    benchmarks.push_back({"state/deserialize", "state", []() -> BenchmarkRun {
+        auto system = StartSerializableSystem();
+
+        {
+            std::ofstream out(SaveStatePath(), std::ios::binary);
+            system->gb->Serialize(out);
+        }
+
+        auto in = std::make_shared<std::ifstream>(SaveStatePath(), std::ios::binary);
+
+        if (in->fail())
+        {
+            std::cerr << "Failed to open " << SaveStatePath() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        return [system, in]() -> uint64_t {
+            for (int i = 0; i < STATES_PER_RUN; ++i)
+            {
+                in->clear();
+                in->seekg(0);
+                system->gb->Deserialize(*in);
+            }
+
+            return STATES_PER_RUN;
+        };
+    }});
+}
@@ -4,32 +4,133 @@
 
 extern "C"
 {
+/// @brief Opaque handle to one emulator instance. Instances share no state, so separate instances may be run concurrently
+///        from different threads. A single instance may be used from several threads, e.g. reading audio on an audio callback
+///        thread while setting inputs from a GUI thread, but StartEmulation and StopEmulation must not race each other.
+struct GBC_Instance;
+
+/// @brief Create a new emulator instance.
+/// @return Handle to pass to every other function.
+GBC_Instance* GBC_Create();
+
+/// @brief Destroy an emulator instance, creating a save file first if the loaded game is battery-backed. Must not be called
+///        from the frame ready callback, since the instance is still running the callback. Stop emulation from the callback
+///        and destroy the instance afterwards instead.
+/// @param gbc Emulator instance to destroy.
+void GBC_Destroy(GBC_Instance* gbc);
+
 /// @brief Initialize the Game Boy before use.
-/// @param[in] frameBuffer Frame buffer to write pixel data to. Must be 69120 bytes (width * height * bpp = 160 * 144 * 3).
-/// @param[in] updateScreen  Function to call anytime the frame buffer is ready to be rendered.
-void Initialize(uint8_t* frameBuffer, void(*updateScreen)());
+/// @param gbc Emulator instance.
+/// @param[in] frameBuffer Frame buffer to write pixel data to. Must be 69120 bytes (width * height * bpp = 160 * 144 * 3), or
+///                        larger if a pixel format with more bytes per pixel is used. The frame is rendered straight into it,
+///                        so it may be mid-render when read. Pass null to have the library own triple-buffered frames
+///                        instead, read with AcquireFrame and ReleaseFrame.
+/// @param[in] updateScreen  Function to call anytime a frame is ready to be rendered.
+/// @param[in] userData Value passed to updateScreen, e.g. to identify which instance has a frame ready.
+void Initialize(GBC_Instance* gbc, uint8_t* frameBuffer, void(*updateScreen)(void*), void* userData);
 
 /// @brief Update the game loaded into the Game Boy.
+/// @param gbc Emulator instance.
 /// @param[in] romPath Path to .gb or .gbc file to load.
 /// @param[in] saveDirectory Path to directory to store save data for games with battery-backed SRAM.
 /// @param[out] romName ROM name from cartridge header.
 /// @return True if ROM was successfully loaded.
-bool InsertCartridge(char* romPath, char* saveDirectory, char* romName);
+bool InsertCartridge(GBC_Instance* gbc, char* romPath, char* saveDirectory, char* romName);
 
 /// @brief Load up the game ROM and boot ROM (if they are provided),and reset the Game Boy to its initial power up state.
+/// @param gbc Emulator instance.
 /// @param[in] bootRomPath Path of Game Boy Color boot ROM file. If not provided, boot up sequence will be skipped.
-void PowerOn(char* bootRomPath);
+void PowerOn(GBC_Instance* gbc, char* bootRomPath);
 
 /// @brief Unload the current game ROM and create a save file if its battery-backed.
-void PowerOff();
+/// @param gbc Emulator instance.
+void PowerOff(GBC_Instance* gbc);
 
 /// @brief Run the Game Boy and collect the specified number of audio samples. If a frame is ready to be displayed while collecting
 ///        samples, call the frame ready callback.
+/// @param gbc Emulator instance.
 /// @param buffer Buffer to write 2-channel 32-bit float PCM samples to.
 /// @param numSamples Number of samples to collect.
-void CollectAudioSamples(float* buffer, int numSamples);
+void CollectAudioSamples(GBC_Instance* gbc, float* buffer, int numSamples);
+
+/// @brief Start running the Game Boy on a thread owned by the library. The thread runs just far enough ahead of playback to
+///        keep a buffer of audio samples filled, so it runs in real time as long as audio is read with ReadAudio. The frame
+///        ready callback and save state file I/O happen on this thread. Other functions may still be called while it runs.
+/// @param gbc Emulator instance.
+void StartEmulation(GBC_Instance* gbc);
+
+/// @brief Stop the thread started by StartEmulation, waiting for it to finish what it's running. Samples already produced
+///        can still be read with ReadAudio. May be called from the frame ready callback, in which case it returns right away
+///        and the thread stops once the callback returns.
+/// @param gbc Emulator instance.
+void StopEmulation(GBC_Instance* gbc);
+
+/// @brief Get the most recently finished frame without copying it. Only available if Initialize was given a null frame buffer.
+///        The frame stays untouched until ReleaseFrame is called, however far emulation runs ahead in the meantime, and calling
+///        this again before then returns the same frame. May be called from any one thread, e.g. a GUI thread, while emulation
+///        runs on another.
+/// @param gbc Emulator instance.
+/// @return Pointer to 160 * 144 pixels in the current pixel format, or null if the caller provided its own frame buffer.
+uint8_t const* AcquireFrame(GBC_Instance* gbc);
+
+/// @brief Finish reading the frame returned by AcquireFrame. The pointer must not be used afterwards.
+/// @param gbc Emulator instance.
+void ReleaseFrame(GBC_Instance* gbc);
+
+/// @brief Pace the emulation thread to the display rather than to audio playback, so that frames are ready at a steady rate of
+///        one per refresh. If the display refreshes within 1% of the Game Boy's ~59.73 Hz, emulation runs slightly faster or
+///        slower to produce exactly one frame per refresh. Audio stays in sync by resampling up to 0.5% faster or slower to keep
+///        the amount of buffered audio at a small target, which lets audio devices use small buffers without dropouts.
+/// @param gbc Emulator instance.
+/// @param refreshRate Display refresh rate in Hz, or 0 to pace emulation by how fast audio is read (default).
+void SetDisplayRefreshRate(GBC_Instance* gbc, double refreshRate);
+
+/// @brief Take audio samples produced by the emulation thread. Never blocks, so this is safe to call from an audio callback.
+/// @param gbc Emulator instance.
+/// @param buffer Buffer to write 2-channel 32-bit float PCM samples to. Anything the emulation thread hasn't produced yet is
+///               filled with silence.
+/// @param numSamples Number of samples to read.
+/// @return Number of samples actually produced by the emulator. Less than numSamples if the buffer ran dry.
+int ReadAudio(GBC_Instance* gbc, float* buffer, int numSamples);
+
+/// @brief Length of a frame in machine cycles. A frame is 154 lines * 114 machine cycles.
+enum
+{
+    GBC_M_CYCLES_PER_FRAME = 17556,
+
+    // Machine cycles after which RunFrames counts a frame even if the PPU hasn't finished one, e.g. because the LCD is off
+    GBC_MAX_M_CYCLES_PER_FRAME = 2 * GBC_M_CYCLES_PER_FRAME,
+};
+
+/// @brief Run the Game Boy as fast as possible for some number of frames, independent of audio playback. Audio samples aren't
+///        produced while running this way. The frame ready callback is called for each frame.
+/// @param gbc Emulator instance.
+/// @param numFrames Number of frames to run. A frame's worth of time without the PPU finishing a frame, e.g. because the
+///                  LCD is off, also counts as a frame.
+/// @return Number of frames run.
+int RunFrames(GBC_Instance* gbc, int numFrames);
+
+/// @brief Run the Game Boy as fast as possible until it has run a total number of machine cycles since power on, independent
+///        of audio playback. Audio samples aren't produced while running this way. The frame ready callback is called for
+///        each frame.
+/// @param gbc Emulator instance.
+/// @param cycle Total number of machine cycles to run to. Use GetCycleCount to find the current total.
+/// @return Number of frames completed.
+int RunUntil(GBC_Instance* gbc, uint64_t cycle);
+
+/// @brief Get the number of machine cycles run since power on.
+/// @param gbc Emulator instance.
+/// @return Total machine cycles run.
+uint64_t GetCycleCount(GBC_Instance* gbc);
+
+/// @brief Only check whether the APU's output changed once every few M-cycles. Pair this with SetClockMultiplier when running
+///        many times faster than real time so that the cost of producing audio stays about the same as at normal speed.
+/// @param gbc Emulator instance.
+/// @param factor Check one of every factor M-cycles. 1 checks every M-cycle (default).
+void SetAudioDecimation(GBC_Instance* gbc, int factor);
 
 /// @brief Update the Joypad register based on which buttons are currently pressed.
+/// @param gbc Emulator instance.
 /// @param[in] down True if the down button is currently pressed.
 /// @param[in] up True if the up button is currently pressed.
 /// @param[in] left True if the left button is currently pressed.
@@ -38,46 +139,84 @@ void CollectAudioSamples(float* buffer, int numSamples);
 /// @param[in] select True if the select button is currently pressed.
 /// @param[in] b True if the b button is currently pressed.
 /// @param[in] a True if the a button is currently pressed.
-void SetInputs(bool down, bool up, bool left, bool right, bool start, bool select, bool b, bool a);
+void SetInputs(GBC_Instance* gbc, bool down, bool up, bool left, bool right, bool start, bool select, bool b, bool a);
 
 /// @brief Change how fast the emulated CPU runs to alter emulation speed.
+/// @param gbc Emulator instance.
 /// @param multiplier Clock speed multiplier.
-void SetClockMultiplier(float multiplier);
+void SetClockMultiplier(GBC_Instance* gbc, float multiplier);
 
-/// @brief Generate a save state and save to the specified file.
+/// @brief Generate a save state and save to the specified file. This happens right away if the Game Boy is at a point where it
+///        can be serialized, or otherwise at the end of the next frame it finishes.
+/// @param gbc Emulator instance.
 /// @param[in] saveStatePath Path to save state file to create.
-void CreateSaveState(char* saveStatePath);
+void CreateSaveState(GBC_Instance* gbc, char* saveStatePath);
 
-/// @brief Load a save state from the specified file.
+/// @brief Load a save state from the specified file. This happens right away if the Game Boy was just powered on or is at a
+///        point where it can be serialized, or otherwise at the end of the next frame it finishes.
+/// @param gbc Emulator instance.
 /// @param[in] saveStatePath Path to save state file to load.
-void LoadSaveState(char* saveStatePath);
+void LoadSaveState(GBC_Instance* gbc, char* saveStatePath);
 
 /// @brief Set whether a specific sound channel should be mixed in to the APU output.
+/// @param gbc Emulator instance.
 /// @param channel Channel number to set (1-4).
 /// @param enabled True to enable channel, false to disable it.
-void EnableSoundChannel(int channel, bool enabled);
+void EnableSoundChannel(GBC_Instance* gbc, int channel, bool enabled);
 
 /// @brief Choose whether to output
+/// @param gbc Emulator instance.
 /// @param monoAudio True to use mono, false to use stereo.
-void SetMonoAudio(bool monoAudio);
+void SetMonoAudio(GBC_Instance* gbc, bool monoAudio);
 
 /// @brief Set the volume of the APU output.
+/// @param gbc Emulator instance.
 /// @param volume Volume of output (between 0.0 and 1.0).
-void SetVolume(float volume);
+void SetVolume(GBC_Instance* gbc, float volume);
 
 /// @brief  Set the sampling frequency.
-/// @param sampleRate Sampling frequency in Hz.
-void SetSampleRate(int sampleRate);
+/// @param gbc Emulator instance.
+/// @param sampleRate Sampling frequency in Hz. Ignored if it isn't positive.
+void SetSampleRate(GBC_Instance* gbc, int sampleRate);
+
+/// @brief Layout of each pixel in the frame buffer. Byte formats are in memory order, word formats are native-endian.
+enum GBC_PixelFormat
+{
+    GBC_PIXEL_FORMAT_RGB888 = 0,  // 3 bytes: R, G, B (default)
+    GBC_PIXEL_FORMAT_RGBA8888,    // 4 bytes: R, G, B, 0xFF
+    GBC_PIXEL_FORMAT_XRGB8888,    // 32-bit word: 0xFFRRGGBB
+    GBC_PIXEL_FORMAT_RGB565,      // 16-bit word: 5 bits of red (top), 6 of green, 5 of blue
+    GBC_PIXEL_FORMAT_RGB555,      // 16-bit word: 5 bits each of red (bottom), green, blue, as stored in CGB palette RAM
+    GBC_PIXEL_FORMAT_INDEXED8,    // 1 byte: DMG shade (0 = lightest, 3 = darkest) for GB games, or an index into the palette
+                                  // table for GBC games (0xFF for a blank pixel). See GetPaletteTable.
+};
+
+/// @brief Choose how pixels are written to the frame buffer. Each pixel is written as a single 8, 16, or 32-bit store rather than
+///        byte by byte, except for RGB888.
+/// @param gbc Emulator instance.
+/// @param format Format of each pixel.
+void SetPixelFormat(GBC_Instance* gbc, GBC_PixelFormat format);
+
+/// @brief Get the colors that GBC_PIXEL_FORMAT_INDEXED8 pixels refer to. Games can change colors at any time, so this only
+///        matches a frame if it's read right after it, e.g. from the frame ready callback, and the game didn't change colors
+///        part way through drawing it.
+/// @param gbc Emulator instance.
+/// @param[out] table Array of 64 RGB555 colors to fill. For GBC games, entries 0-31 are the 8 background palettes and entries
+///                   32-63 are the 8 sprite palettes, 4 colors each. For GB games, entries 0-3 are the colors of each shade.
+void GetPaletteTable(GBC_Instance* gbc, uint16_t* table);
 
 /// @brief Use custom DMG palettes when playing GB games.
+/// @param gbc Emulator instance.
 /// @param useDmgColors True if DMG colors should be used.
-void PreferDmgColors(bool useDmgColors);
+void PreferDmgColors(GBC_Instance* gbc, bool useDmgColors);
 
 /// @brief Determine whether background, window, obp0, and obp1 should use the same palette or individual ones.
+/// @param gbc Emulator instance.
 /// @param individualPalettes True if each pixel type should use its own palette.
-void UseIndividualPalettes(bool individualPalettes);
+void UseIndividualPalettes(GBC_Instance* gbc, bool individualPalettes);
 
 /// @brief Specify colors in one of the custom DMG palettes.
+/// @param gbc Emulator instance.
 /// @param index Index of palette to update.
 ///                 0 = Universal palette
 ///                 1 = Background
@@ -85,5 +224,61 @@ void UseIndividualPalettes(bool individualPalettes);
 ///                 3 = OBP0
 ///                 4 = OBP1
 /// @param data Pointer to RGB data (12 0-255 values)
-void SetCustomPalette(uint8_t index, uint8_t* data);
+void SetCustomPalette(GBC_Instance* gbc, uint8_t index, uint8_t* data);
+
+/// @brief Choose whether the CPU may execute whole instructions at once when nothing else can observe its memory accesses
+///        mid-instruction. This does not change emulated behavior, only how much work is needed to emulate it.
+/// @param gbc Emulator instance.
+/// @param enabled True to enable instruction stepping (default), false to clock every component each M-cycle.
+void SetInstructionStepping(GBC_Instance* gbc, bool enabled);
+
+/// @brief Choose whether the PPU renders each scanline in one go rather than running its pixel FIFO every dot. Lines where the
+///        game changes rendering registers mid-scanline fall back to the pixel FIFO, so this only changes emulation speed.
+/// @param gbc Emulator instance.
+/// @param enabled True to use the scanline renderer, false to always use the pixel FIFO (default).
+void SetScanlineRenderer(GBC_Instance* gbc, bool enabled);
+
+/// @brief Only produce pixels for one of every few frames, e.g. while fast-forwarding. Skipped frames are emulated with exact
+///        timing, so games behave the same, but no pixel colors are worked out or written. The frame ready callback isn't
+///        called for skipped frames and AcquireFrame keeps returning the last rendered one. RunFrames still counts them.
+/// @param gbc Emulator instance.
+/// @param framesToSkip Number of frames to skip after each rendered frame (0-255). 0 renders every frame (default).
+void SetFrameSkip(GBC_Instance* gbc, int framesToSkip);
+
+/// @brief Hash a frame, e.g. to check whether two runs of a game rendered the same thing.
+/// @param[in] frameBuffer Frame to hash.
+/// @param size Size of the frame in bytes.
+/// @return 64-bit FNV-1a hash of the frame, the same hash that RunBatch reports.
+uint64_t HashFrameBuffer(uint8_t const* frameBuffer, int size);
+
+/// @brief A headless run of a game for RunBatch.
+struct GBC_BatchJob
+{
+    char const* romPath;          // Path to .gb or .gbc file to run
+    char const* saveStatePath;    // Save state to load after powering on, or null/empty to start from power on
+    char const* inputScriptPath;  // Input script to play back, or null/empty for no input
+    char const* ramDumpPath;      // File to write WRAM and HRAM to once the job finishes, or null/empty for none
+    int frames;                   // Number of frames to run for
+};
+
+/// @brief Outcome of a GBC_BatchJob.
+struct GBC_BatchResult
+{
+    bool success;        // False if the ROM, save state, or input script couldn't be loaded
+    int framesRun;       // Number of frames run
+    uint64_t cyclesRun;  // Number of machine cycles run
+    uint64_t frameHash;  // 64-bit FNV-1a hash of the final frame (160 * 144 * 3 RGB bytes)
+};
+
+/// @brief Run many games headlessly across a pool of worker threads. Each job runs on its own emulator, independent of any
+///        instance created with GBC_Create, and no save files are written. Boot ROMs are skipped.
+///
+///        An input script is a text file with one line per change in joypad state: a frame number followed by the buttons held
+///        from that frame onward (any of up, down, left, right, start, select, b, a). A line with only a frame number releases
+///        every button. Lines must be in frame order, and blank lines or lines starting with # are ignored.
+/// @param[in] jobs Array of jobs to run.
+/// @param[out] results Array to write the result of each job to, in the same order as jobs.
+/// @param[in] numJobs Number of jobs. Nothing is run if this isn't positive.
+/// @param[in] numThreads Number of worker threads to use. If 0, use one per hardware thread.
+void RunBatch(GBC_BatchJob const* jobs, GBC_BatchResult* results, int numJobs, int numThreads);
 }
@@ -1,39 +1,20 @@
 #include <APU.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <vector>
 
-static std::vector<float> LEFT_SAMPLE_BUFFER;
-static std::vector<float> RIGHT_SAMPLE_BUFFER;
+static constexpr float HPF_CHARGE_FACTOR = 0.996;  // Fraction of the capacitor's charge kept across one M-cycle
+static constexpr double CPU_CLOCK_FREQUENCY = 1048576.0;  // M-cycles per second
+static constexpr int DEFAULT_SAMPLE_RATE = 44100;
 
-static float LAST_LEFT_SAMPLE = 0.0;
-static float LAST_RIGHT_SAMPLE = 0.0;
+// Seconds of audio that can be drained at once without allocating. Audio callbacks and display refresh intervals ask for far
+// less than this.
+static constexpr double PREALLOCATED_AUDIO_LENGTH = 0.25;
 
-static int DOWNSAMPLED_RATE = 44100;
-static constexpr float DELTA_T = 1.0 / 1048576;  // Time between samples
-static float TAU = 1.0 / (DOWNSAMPLED_RATE / 2);  // Time constant
-static float ALPHA = DELTA_T / TAU;
-
-static std::vector<float> LPF(std::vector<float> const& input, float& lastSample)
-{
-    std::vector<float> output;
-    output.reserve(input.size());
-
-    float out = lastSample;
-
-    for (size_t i = 0; i < input.size(); ++i)
-    {
-        out += ALPHA * (input[i] - out);
-        output.push_back(out);
-    }
-
-    if (!output.empty())
-    {
-        lastSample = output[output.size() - 1];
-    }
-
-    return output;
-}
+// Amplitude changes that can be recorded between drains without allocating. Busy music changes output a few thousand times
+// per frame, this leaves room for several frames between drains.
+static constexpr size_t INITIAL_CHANGE_CAPACITY = 1 << 15;
 
 APU::APU() :
     monoAudio_(false),
@@ -42,23 +23,60 @@ APU::APU() :
     channel2Disabled_(false),
     channel3Disabled_(false),
     channel4Disabled_(false),
-    apuEnabled_(false)
+    apuEnabled_(false),
+    sampleClock_(0),
+    channelSamples_({0.0, 0.0, 0.0, 0.0}),
+    mixDirty_(true),
+    outputLeft_(0.0),
+    outputRight_(0.0),
+    sampleDecimation_(1),
+    decimationCounter_(0)
 {
+    amplitudeChanges_.reserve(INITIAL_CHANGE_CAPACITY);
+    SetSampleRate(DEFAULT_SAMPLE_RATE);
 }
 
 void APU::Clock()
 {
-    if (!apuEnabled_)
+    std::array<float, 4> samples = {0.0, 0.0, 0.0, 0.0};
+
+    if (apuEnabled_)
+    {
+        samples = {channel1_.Clock(), channel2_.Clock(), channel3_.Clock(), channel4_.Clock()};
+    }
+
+    if (sampleDecimation_ == 0)
+    {
+        return;
+    }
+
+    uint32_t const cycle = sampleClock_++;
+
+    if (sampleDecimation_ > 1)
+    {
+        if (++decimationCounter_ < sampleDecimation_)
+        {
+            return;
+        }
+
+        decimationCounter_ = 0;
+    }
+
+    // Channel outputs only change every few M-cycles, so most of the time there's nothing to mix.
+    if (!mixDirty_ && (samples == channelSamples_))
     {
-        LEFT_SAMPLE_BUFFER.push_back(0.0);
-        RIGHT_SAMPLE_BUFFER.push_back(0.0);
         return;
     }
 
-    float channel1Sample = channel1_.Clock();
-    float channel2Sample = channel2_.Clock();
-    float channel3Sample = channel3_.Clock();
-    float channel4Sample = channel4_.Clock();
+    channelSamples_ = samples;
+    mixDirty_ = false;
+    auto [left, right] = apuEnabled_ ? Mix() : std::pair<float, float>(0.0, 0.0);
+    SetOutput(cycle, left, right);
+}
+
+std::pair<float, float> APU::Mix() const
+{
+    auto [channel1Sample, channel2Sample, channel3Sample, channel4Sample] = channelSamples_;
 
     uint_fast8_t leftCount = 0;
     uint_fast8_t rightCount = 0;
@@ -150,11 +168,17 @@ void APU::Clock()
         right_sample *= rightVolume_;
     }
 
-    left_sample = HPF(left_sample) * volume_;
-    right_sample = HPF(right_sample) * volume_;
+    return {left_sample, right_sample};
+}
 
-    LEFT_SAMPLE_BUFFER.push_back(left_sample);
-    RIGHT_SAMPLE_BUFFER.push_back(right_sample);
+void APU::SetOutput(uint32_t const cycle, float const left, float const right)
+{
+    if ((left != outputLeft_) || (right != outputRight_))
+    {
+        amplitudeChanges_.push_back({cycle, left - outputLeft_, right - outputRight_});
+        outputLeft_ = left;
+        outputRight_ = right;
+    }
 }
 
 void APU::PowerOn(bool const skipBootRom)
@@ -196,56 +220,80 @@ void APU::PowerOn(bool const skipBootRom)
 
 void APU::SetSampleRate(int const sampleRate)
 {
-    DOWNSAMPLED_RATE = sampleRate;
-    TAU = 1.0 / (DOWNSAMPLED_RATE / 2);
-    ALPHA = DELTA_T / TAU;
-    LEFT_SAMPLE_BUFFER.clear();
-    RIGHT_SAMPLE_BUFFER.clear();
+    DiscardSamples();
+    blip_.Reserve(static_cast<size_t>(sampleRate * PREALLOCATED_AUDIO_LENGTH));
+
+    // The high pass filter runs once per output sample, so discharge the capacitor by however many M-cycles each covers.
+    hpfChargeFactor_ = std::pow(HPF_CHARGE_FACTOR, CPU_CLOCK_FREQUENCY / sampleRate);
 }
 
-void APU::DrainSampleBuffer(float* buffer, int count)
+void APU::SetSampleDecimation(int const factor)
 {
-    auto filteredLeftBuffer = LPF(LEFT_SAMPLE_BUFFER, LAST_LEFT_SAMPLE);
-    auto filteredRightBuffer = LPF(RIGHT_SAMPLE_BUFFER, LAST_RIGHT_SAMPLE);
+    sampleDecimation_ = factor;
+    decimationCounter_ = 0;
+}
 
-    int numSamples = count / 2;
-    float downsampleDivider = static_cast<float>(LEFT_SAMPLE_BUFFER.size()) / numSamples;
+void APU::DrainSampleBuffer(float* buffer, int count)
+{
+    int const numSamples = count / 2;
 
-    for (int output_index = 0; output_index < count; output_index += 2)
+    if ((numSamples > 0) && (sampleClock_ > 0))
     {
-        size_t index = std::round((output_index / 2) * downsampleDivider);
+        double const samplesPerCycle = static_cast<double>(numSamples) / sampleClock_;
 
-        if (index >= filteredLeftBuffer.size())
+        for (auto const& change : amplitudeChanges_)
         {
-            buffer[output_index] = 0.0;
-            buffer[output_index + 1] = 0.0;
-        }
-        else
-        {
-            buffer[output_index] = filteredLeftBuffer[index];
-            buffer[output_index + 1] = filteredRightBuffer[index];
+            double const time = change.cycle * samplesPerCycle;
+            blip_.AddDelta(time, change.left, change.right);
         }
     }
 
-    LEFT_SAMPLE_BUFFER.clear();
-    RIGHT_SAMPLE_BUFFER.clear();
+    blip_.ReadSamples(buffer, numSamples);
+
+    for (int i = 0; i < (numSamples * 2); ++i)
+    {
+        buffer[i] = HPF(buffer[i]) * volume_;
+    }
+
+    amplitudeChanges_.clear();
+    sampleClock_ = 0;
 }
 
-void APU::ClockDIV(bool const doubleSpeed)
+void APU::DiscardSamples()
 {
-    ++divDivider_;
+    amplitudeChanges_.clear();
+    sampleClock_ = 0;
+    blip_.Reset(outputLeft_, outputRight_);
+}
 
-    if (divDivider_ == 64)
+void APU::AdvanceDIV(uint64_t ticks, bool const doubleSpeed)
+{
+    uint_fast16_t const period = FrameSequencerPeriod(doubleSpeed);
+    uint_fast16_t counter = (DIV_ << 6) | divDivider_;
+
+    while (ticks > 0)
     {
-        divDivider_ = 0;
-        bool wasApuDivBitSet = DIV_++ & (doubleSpeed ? 0x20 : 0x10);
-        bool isApuDivBitSet = DIV_ & (doubleSpeed ? 0x20 : 0x10);
+        uint_fast16_t const ticksUntilEdge = period - (counter % period);
 
-        if (wasApuDivBitSet && !isApuDivBitSet)
+        if (ticks < ticksUntilEdge)
         {
-            AdvanceFrameSequencer();
+            counter += ticks;
+            break;
         }
+
+        counter = (counter + ticksUntilEdge) & DIV_COUNTER_MASK;
+        ticks -= ticksUntilEdge;
+        AdvanceFrameSequencer();
     }
+
+    DIV_ = (counter >> 6) & 0xFF;
+    divDivider_ = counter & 0x3F;
+}
+
+uint_fast16_t APU::TicksUntilFrameSequencer(bool const doubleSpeed) const
+{
+    uint_fast16_t const period = FrameSequencerPeriod(doubleSpeed);
+    return period - (((DIV_ << 6) | divDivider_) % period);
 }
 
 void APU::ResetDIV(bool const doubleSpeed)
@@ -290,6 +338,8 @@ uint8_t APU::Read(uint8_t ioAddr)
 
 void APU::Write(uint8_t ioAddr, uint8_t data)
 {
+    mixDirty_ = true;
+
     switch (ioAddr)
     {
         case 0x10 ... 0x14:  // NR10 - NR14
@@ -399,10 +449,13 @@ void APU::Deserialize(std::ifstream& in)
     channel2_.Deserialize(in);
     channel3_.Deserialize(in);
     channel4_.Deserialize(in);
+    mixDirty_ = true;
 }
 
 void APU::EnableSoundChannel(int const channel, bool const enabled)
 {
+    mixDirty_ = true;
+
     switch (channel)
     {
         case 1:
@@ -425,7 +478,7 @@ void APU::EnableSoundChannel(int const channel, bool const enabled)
 float APU::HPF(float input)
 {
     float output = input - capacitor_;
-    capacitor_ = input - (output * 0.996);
+    capacitor_ = input - (output * hpfChargeFactor_);
     return output;
 }
 
@@ -0,0 +1,58 @@
+#include <AudioRingBuffer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+AudioRingBuffer::AudioRingBuffer(size_t const capacity) :
+    writeCount_(0),
+    readCount_(0)
+{
+    size_t size = 1;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    buffer_.resize(size, 0.0);
+    mask_ = size - 1;
+}
+
+size_t AudioRingBuffer::Write(float const* samples, size_t const count)
+{
+    size_t const writeCount = writeCount_.load(std::memory_order_relaxed);
+    size_t const readCount = readCount_.load(std::memory_order_acquire);
+    size_t const numSamples = std::min(count, buffer_.size() - (writeCount - readCount));
+    size_t const start = writeCount & mask_;
+    size_t const firstPart = std::min(numSamples, buffer_.size() - start);
+
+    std::copy(samples, samples + firstPart, buffer_.begin() + start);
+    std::copy(samples + firstPart, samples + numSamples, buffer_.begin());
+
+    // Publish the samples only once they've been copied in.
+    writeCount_.store(writeCount + numSamples, std::memory_order_release);
+    return numSamples;
+}
+
+size_t AudioRingBuffer::Read(float* samples, size_t const count)
+{
+    size_t const readCount = readCount_.load(std::memory_order_relaxed);
+    size_t const writeCount = writeCount_.load(std::memory_order_acquire);
+    size_t const numSamples = std::min(count, writeCount - readCount);
+    size_t const start = readCount & mask_;
+    size_t const firstPart = std::min(numSamples, buffer_.size() - start);
+
+    std::copy(buffer_.begin() + start, buffer_.begin() + start + firstPart, samples);
+    std::copy(buffer_.begin(), buffer_.begin() + (numSamples - firstPart), samples + firstPart);
+
+    // Hand the space back to the producer only once the samples have been copied out.
+    readCount_.store(readCount + numSamples, std::memory_order_release);
+    return numSamples;
+}
+
+size_t AudioRingBuffer::Size() const
+{
+    size_t const readCount = readCount_.load(std::memory_order_acquire);
+    size_t const writeCount = writeCount_.load(std::memory_order_acquire);
+    return writeCount - readCount;
+}
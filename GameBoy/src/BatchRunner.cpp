@@ -0,0 +1,259 @@
+#include <BatchRunner.hpp>
+#include <GameBoy.hpp>
+#include <GBC.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static constexpr size_t FRAME_BUFFER_SIZE = 160 * 144 * 3;
+
+static constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+static constexpr uint64_t FNV_PRIME = 0x00000100000001B3;
+
+/// @brief Joypad state starting at a given frame, in the order GameBoy::SetButtons takes them.
+struct InputEvent
+{
+    int frame;
+    std::array<bool, 8> buttons;
+};
+
+static std::optional<std::vector<InputEvent>> LoadInputScript(std::filesystem::path const& scriptPath)
+{
+    static constexpr std::array<char const*, 8> BUTTON_NAMES = {"down", "up", "left", "right", "start", "select", "b", "a"};
+
+    std::ifstream script(scriptPath);
+
+    if (script.fail())
+    {
+        return {};
+    }
+
+    std::vector<InputEvent> events;
+    std::string line;
+
+    while (std::getline(script, line))
+    {
+        std::istringstream tokens(line);
+        InputEvent event{};
+
+        if (line.empty() || (line[0] == '#') || !(tokens >> event.frame))
+        {
+            continue;
+        }
+
+        std::string button;
+
+        while (tokens >> button)
+        {
+            auto it = std::find(BUTTON_NAMES.begin(), BUTTON_NAMES.end(), button);
+
+            if (it == BUTTON_NAMES.end())
+            {
+                return {};
+            }
+
+            event.buttons[it - BUTTON_NAMES.begin()] = true;
+        }
+
+        events.push_back(event);
+    }
+
+    return events;
+}
+
+uint64_t HashFrame(uint8_t const* frameBuffer, size_t const size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ frameBuffer[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+BatchResult RunBatchJob(BatchJob const& job)
+{
+    BatchResult result{false, 0, 0, HashFrame(nullptr, 0)};
+    std::vector<InputEvent> inputs;
+
+    if (!job.inputScriptPath.empty())
+    {
+        auto script = LoadInputScript(job.inputScriptPath);
+
+        if (!script)
+        {
+            return result;
+        }
+
+        inputs = std::move(*script);
+    }
+
+    std::vector<uint8_t> frameBuffer(FRAME_BUFFER_SIZE);
+    auto gb = std::make_unique<GameBoy>();
+    gb->Initialize(frameBuffer.data());
+
+    char romName[17];
+
+    if (!gb->InsertCartridge(job.romPath, "", romName))
+    {
+        return result;
+    }
+
+    gb->PowerOn("");
+    gb->SetScanlineRenderer(true);
+
+    if (!job.saveStatePath.empty())
+    {
+        std::ifstream in(job.saveStatePath, std::ios::binary);
+
+        if (in.fail())
+        {
+            return result;
+        }
+
+        gb->Deserialize(in);
+    }
+
+    size_t nextInput = 0;
+
+    while (result.framesRun < job.frames)
+    {
+        while ((nextInput < inputs.size()) && (inputs[nextInput].frame <= result.framesRun))
+        {
+            auto const& b = inputs[nextInput++].buttons;
+            gb->SetButtons(b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]);
+        }
+
+        int cyclesRemaining = GBC_MAX_M_CYCLES_PER_FRAME;
+
+        while (cyclesRemaining > 0)
+        {
+            auto [cyclesRun, frameReady] = gb->Clock(cyclesRemaining);
+            cyclesRemaining -= cyclesRun;
+            result.cyclesRun += cyclesRun;
+
+            if (frameReady)
+            {
+                break;
+            }
+        }
+
+        gb->DiscardSamples();
+        ++result.framesRun;
+    }
+
+    result.frameHash = HashFrame(frameBuffer.data(), frameBuffer.size());
+
+    if (!job.ramDumpPath.empty())
+    {
+        std::ofstream out(job.ramDumpPath, std::ios::binary);
+
+        if (!out.fail())
+        {
+            gb->DumpRam(out);
+        }
+    }
+
+    result.success = true;
+    return result;
+}
+
+/// @brief Queue of job indices owned by one worker. The owner takes work from the back while idle workers steal from the front.
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+};
+
+static std::optional<size_t> PopJob(WorkQueue& queue, bool steal)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.jobs.empty())
+    {
+        return {};
+    }
+
+    size_t index;
+
+    if (steal)
+    {
+        index = queue.jobs.front();
+        queue.jobs.pop_front();
+    }
+    else
+    {
+        index = queue.jobs.back();
+        queue.jobs.pop_back();
+    }
+
+    return index;
+}
+
+std::vector<BatchResult> RunBatch(std::vector<BatchJob> const& jobs, unsigned int numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    numThreads = std::max(std::min<size_t>(numThreads, jobs.size()), size_t{1});
+    std::vector<BatchResult> results(jobs.size());
+    std::vector<WorkQueue> queues(numThreads);
+
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        queues[i % numThreads].jobs.push_back(i);
+    }
+
+    // No jobs are added once workers start, so a worker can exit as soon as every queue is empty.
+    auto worker = [&](size_t const id)
+    {
+        while (true)
+        {
+            std::optional<size_t> index = PopJob(queues[id], false);
+
+            for (size_t offset = 1; !index && (offset < numThreads); ++offset)
+            {
+                index = PopJob(queues[(id + offset) % numThreads], true);
+            }
+
+            if (!index)
+            {
+                return;
+            }
+
+            results[*index] = RunBatchJob(jobs[*index]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    for (size_t id = 1; id < numThreads; ++id)
+    {
+        threads.emplace_back(worker, id);
+    }
+
+    worker(0);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return results;
+}
@@ -0,0 +1,119 @@
+#include <BlipBuffer.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+static constexpr double PI = 3.14159265358979323846;
+
+// Fraction of the output's Nyquist frequency to pass. Leaves room for the window's transition band below Nyquist.
+static constexpr double CUTOFF = 0.9;
+
+BlipBuffer::BlipBuffer() :
+    end_(0),
+    amplitude_({0.0, 0.0})
+{
+    deltas_.resize(2 * (INITIAL_CAPACITY + KERNEL_WIDTH + 1), 0.0);
+}
+
+std::array<BlipBuffer::Kernel, BlipBuffer::PHASES + 1> const& BlipBuffer::Kernels()
+{
+    // Windowed sinc impulses, one per phase. Tap k of each lands KERNEL_WIDTH / 2 output samples after the step it belongs to.
+    static auto const kernels = []()
+    {
+        std::array<Kernel, PHASES + 1> table;
+
+        for (int p = 0; p <= PHASES; ++p)
+        {
+            double const offset = static_cast<double>(p) / PHASES;
+            std::array<double, KERNEL_WIDTH> taps;
+
+            for (int k = 0; k < KERNEL_WIDTH; ++k)
+            {
+                double const x = k - (KERNEL_WIDTH / 2) - offset;
+                double const sinc = (x == 0.0) ? 1.0 : std::sin(PI * CUTOFF * x) / (PI * CUTOFF * x);
+                double const w = 2 * PI * x / KERNEL_WIDTH;
+                double const blackman = (std::abs(x) > (KERNEL_WIDTH / 2)) ? 0.0 : (0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2 * w));
+                taps[k] = sinc * blackman;
+            }
+
+            double const sum = std::accumulate(taps.begin(), taps.end(), 0.0);
+
+            for (int k = 0; k < KERNEL_WIDTH; ++k)
+            {
+                table[p][2 * k] = taps[k] / sum;
+                table[p][(2 * k) + 1] = taps[k] / sum;
+            }
+        }
+
+        return table;
+    }();
+
+    return kernels;
+}
+
+void BlipBuffer::AddDelta(double const time, float const left, float const right)
+{
+    size_t const index = static_cast<size_t>(time);
+    double const position = (time - index) * PHASES;
+    int const phase = static_cast<int>(position);
+    float const blend = position - phase;
+    Reserve(index);
+
+    // Interpolate between the two nearest precomputed phases so steps land exactly where they occurred.
+    auto const& kernels = Kernels();
+    Kernel const& before = kernels[phase];
+    Kernel const& after = kernels[std::min(phase + 1, PHASES)];
+    float const delta[2] = {left, right};
+    float* out = &deltas_[2 * index];
+
+    for (int i = 0; i < (2 * KERNEL_WIDTH); ++i)
+    {
+        out[i] += (before[i] + (blend * (after[i] - before[i]))) * delta[i & 1];
+    }
+
+    end_ = std::max(end_, index + KERNEL_WIDTH);
+}
+
+void BlipBuffer::ReadSamples(float* out, int const count)
+{
+    Reserve(count);
+    float left = amplitude_[0];
+    float right = amplitude_[1];
+
+    for (int i = 0; i < count; ++i)
+    {
+        left += deltas_[2 * i];
+        right += deltas_[(2 * i) + 1];
+        out[2 * i] = left;
+        out[(2 * i) + 1] = right;
+    }
+
+    amplitude_ = {left, right};
+
+    // Only the tail of steps added near the end of what was read can still be nonzero, so that's all that needs to move.
+    size_t const remaining = (end_ > static_cast<size_t>(count)) ? (end_ - count) : 0;
+    std::copy(deltas_.begin() + (2 * count), deltas_.begin() + (2 * (count + remaining)), deltas_.begin());
+    std::fill(deltas_.begin() + (2 * remaining), deltas_.begin() + (2 * std::max(end_, remaining)), 0.0);
+    end_ = remaining;
+}
+
+void BlipBuffer::Reset(float const left, float const right)
+{
+    amplitude_ = {left, right};
+    std::fill(deltas_.begin(), deltas_.begin() + (2 * end_), 0.0);
+    end_ = 0;
+}
+
+void BlipBuffer::Reserve(size_t const time)
+{
+    // Steps may land on the sample after time, so leave room for a full kernel past that.
+    size_t const size = 2 * (time + KERNEL_WIDTH + 1);
+
+    if (deltas_.size() < size)
+    {
+        deltas_.resize(size, 0.0);
+    }
+}
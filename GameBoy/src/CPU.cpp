@@ -1,16 +1,13 @@
 #include <CPU.hpp>
+#include <GameBoy.hpp>
 #include <cstdint>
 #include <fstream>
-#include <functional>
 #include <optional>
 #include <string>
 #include <utility>
 
-CPU::CPU(std::function<uint8_t(uint16_t)> readFunction,
-         std::function<void(uint16_t, uint8_t)> writeFunction,
-         std::function<void()> acknowledgeInterruptFunction,
-         std::function<std::pair<bool, bool>(bool)> stopFunction) :
-    Read(readFunction), Write(writeFunction), AcknowledgeInterrupt(acknowledgeInterruptFunction), ReportStop(stopFunction)
+CPU::CPU(GameBoy& bus) :
+    bus_(bus)
 {
 }
 
@@ -20,7 +17,7 @@ void CPU::PowerOn(bool const skipBootRom)
     opCode_ = 0x00;
     mCycle_ = 0x00;
     prefixedOpCode_ = false;
-    instruction_ = [](){};
+    prefixedInstruction_ = false;
     cmdData8_ = 0x00;
     cmdData16_ = 0x00;
 
@@ -29,10 +26,12 @@ void CPU::PowerOn(bool const skipBootRom)
     setInterruptsDisabled_ = false;
     interruptBeingProcessed_ = false;
     interruptCountdown_ = 0x00;
+    interruptAddr_ = 0x0000;
 
     halted_ = false;
     haltBug_ = false;
     numPendingInterrupts_ = 0x00;
+    locked_ = false;
 
     if (!skipBootRom)
     {
@@ -78,7 +77,7 @@ void CPU::Clock(std::optional<std::pair<uint16_t, uint8_t>> interruptInfo)
             {
                 AcknowledgeInterrupt();
                 --numPendingInterrupts_;
-                instruction_ = std::bind(&CPU::InterruptHandler, this, interruptAddr);
+                interruptAddr_ = interruptAddr;
                 interruptsEnabled_ = false;
                 interruptBeingProcessed_ = true;
             }
@@ -94,13 +93,17 @@ void CPU::Clock(std::optional<std::pair<uint16_t, uint8_t>> interruptInfo)
 
     ++mCycle_;
 
-    if (!interruptBeingProcessed_ && (prefixedOpCode_ || (mCycle_ == 1)))
+    if (interruptBeingProcessed_)
+    {
+        InterruptHandler(interruptAddr_);
+    }
+    else if (prefixedOpCode_ || (mCycle_ == 1))
     {
         DecodeOpCode();
     }
     else
     {
-        instruction_();
+        ExecuteInstruction();
     }
 
     return;
@@ -131,6 +134,7 @@ void CPU::Deserialize(std::ifstream& in)
     in.read(reinterpret_cast<char*>(&halted_), sizeof(halted_));
     in.read(reinterpret_cast<char*>(&haltBug_), sizeof(haltBug_));
     reg_.Deserialize(in);
+    locked_ = false;
 }
 
 uint8_t CPU::ReadPC()
@@ -195,9 +199,6 @@ void CPU::DecodeOpCode()
             case 0x35:
                 SwapRegNibbles(&reg_.L);
                 break;
-            case 0x36:
-                instruction_ = std::bind(&CPU::SwapMemNibbles, this);
-                break;
 
             // RLC n
             case 0x07:
@@ -221,9 +222,6 @@ void CPU::DecodeOpCode()
             case 0x05:
                 RLC(&reg_.L, true);
                 break;
-            case 0x06:
-                instruction_ = std::bind(&CPU::RLCMem, this);
-                break;
 
             // RL n
             case 0x17:
@@ -247,9 +245,6 @@ void CPU::DecodeOpCode()
             case 0x15:
                 RL(&reg_.L, true);
                 break;
-            case 0x16:
-                instruction_ = std::bind(&CPU::RLMem, this);
-                break;
 
             // RRC n
             case 0x0F:
@@ -273,9 +268,6 @@ void CPU::DecodeOpCode()
             case 0x0D:
                 RRC(&reg_.L, true);
                 break;
-            case 0x0E:
-                instruction_ = std::bind(&CPU::RRCMem, this);
-                break;
 
             // RR n
             case 0x1F:
@@ -299,9 +291,6 @@ void CPU::DecodeOpCode()
             case 0x1D:
                 RR(&reg_.L, true);
                 break;
-            case 0x1E:
-                instruction_ = std::bind(&CPU::RRMem, this);
-                break;
 
             // SLA n
             case 0x27:
@@ -325,9 +314,6 @@ void CPU::DecodeOpCode()
             case 0x25:
                 SLA(&reg_.L);
                 break;
-            case 0x26:
-                instruction_ = std::bind(&CPU::SLAMem, this);
-                break;
 
             // SRA n
             case 0x2F:
@@ -351,9 +337,6 @@ void CPU::DecodeOpCode()
             case 0x2D:
                 SRA(&reg_.L);
                 break;
-            case 0x2E:
-                instruction_ = std::bind(&CPU::SRAMem, this);
-                break;
 
             // SRL n
             case 0x3F:
@@ -377,9 +360,6 @@ void CPU::DecodeOpCode()
             case 0x3D:
                 SRL(&reg_.L);
                 break;
-            case 0x3E:
-                instruction_ = std::bind(&CPU::SRLMem, this);
-                break;
 
             // BIT n, r
             case 0x40 ... 0x7F:
@@ -407,9 +387,6 @@ void CPU::DecodeOpCode()
                     case 5:
                         Bit(reg_.L, bit);
                         break;
-                    case 6:
-                        instruction_ = std::bind(&CPU::BitMem, this, bit);
-                        break;
                     case 7:
                         Bit(reg_.A, bit);
                         break;
@@ -443,9 +420,6 @@ void CPU::DecodeOpCode()
                     case 5:
                         Set(&reg_.L, bit);
                         break;
-                    case 6:
-                        instruction_ = std::bind(&CPU::SetMem, this, bit);
-                        break;
                     case 7:
                         Set(&reg_.A, bit);
                         break;
@@ -479,9 +453,6 @@ void CPU::DecodeOpCode()
                     case 5:
                         Res(&reg_.L, bit);
                         break;
-                    case 6:
-                        instruction_ = std::bind(&CPU::ResMem, this, bit);
-                        break;
                     case 7:
                         Res(&reg_.A, bit);
                         break;
@@ -494,29 +465,6 @@ void CPU::DecodeOpCode()
     {
         switch (opCode_)
         {
-            // LD r, n
-            case 0x3E:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.A);
-                break;
-            case 0x06:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.B);
-                break;
-            case 0x0E:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.C);
-                break;
-            case 0x16:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.D);
-                break;
-            case 0x1E:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.E);
-                break;
-            case 0x26:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.H);
-                break;
-            case 0x2E:
-                instruction_ = std::bind(&CPU::LoadImmediateToReg, this, &reg_.L);
-                break;
-
             // LD r, r
             case 0x7F:
                 mCycle_ = 0;
@@ -708,170 +656,6 @@ void CPU::DecodeOpCode()
                 mCycle_ = 0;
                 break;
 
-            // LD (nn), r
-            case 0x02:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.BC, reg_.A);
-                break;
-            case 0x12:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.DE, reg_.A);
-                break;
-            case 0x77:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.A);
-                break;
-            case 0xEA:
-                instruction_ = std::bind(&CPU::LoadRegToAbsoluteMem, this, reg_.A);
-                break;
-            case 0x70:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.B);
-                break;
-            case 0x71:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.C);
-                break;
-            case 0x72:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.D);
-                break;
-            case 0x73:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.E);
-                break;
-            case 0x74:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.H);
-                break;
-            case 0x75:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, reg_.HL, reg_.L);
-                break;
-            case 0x36:
-                instruction_ = std::bind(&CPU::LoadImmediateToMem, this, reg_.HL);
-                break;
-
-            // LD r, (nn)
-            case 0x7E:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.A, reg_.HL);
-                break;
-            case 0x0A:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.A, reg_.BC);
-                break;
-            case 0x1A:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.A, reg_.DE);
-                break;
-            case 0xFA:
-                instruction_ = std::bind(&CPU::LoadAbsoluteMemToReg, this, &reg_.A);
-                break;
-            case 0x46:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.B, reg_.HL);
-                break;
-            case 0x4E:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.C, reg_.HL);
-                break;
-            case 0x56:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.D, reg_.HL);
-                break;
-            case 0x5E:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.E, reg_.HL);
-                break;
-            case 0x66:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.H, reg_.HL);
-                break;
-            case 0x6E:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.L, reg_.HL);
-                break;
-
-            // LD A, ($FF00+C)
-            case 0xF2:
-                instruction_ = std::bind(&CPU::LoadMemToReg, this, &reg_.A, 0xFF00 + reg_.C);
-                break;
-
-            // LD ($FF00+C), A
-            case 0xE2:
-                instruction_ = std::bind(&CPU::LoadRegToMem, this, 0xFF00 + reg_.C, reg_.A);
-                break;
-
-            // LD A, ($FF00+n)
-            case 0xF0:
-                instruction_ = std::bind(&CPU::LoadLastPageToReg, this);
-                break;
-
-            // LD ($FF00+n), A
-            case 0xE0:
-                instruction_ = std::bind(&CPU::LoadRegToLastPage, this);
-                break;
-
-            // LDD A, (HL)
-            case 0x3A:
-                instruction_ = std::bind(&CPU::LoadMemToRegPostfix, this, false);
-                break;
-
-            // LDD (HL), A
-            case 0x32:
-                instruction_ = std::bind(&CPU::LoadRegToMemPostfix, this, false);
-                break;
-
-            // LDI A, (HL)
-            case 0x2A:
-                instruction_ = std::bind(&CPU::LoadMemToRegPostfix, this, true);
-                break;
-
-            // LDI (HL), A
-            case 0x22:
-                instruction_ = std::bind(&CPU::LoadRegToMemPostfix, this, true);
-                break;
-
-            // LD rr, nn
-            case 0x01:
-                instruction_ = std::bind(&CPU::LoadImmediate16ToReg, this, &reg_.BC);
-                break;
-            case 0x11:
-                instruction_ = std::bind(&CPU::LoadImmediate16ToReg, this, &reg_.DE);
-                break;
-            case 0x21:
-                instruction_ = std::bind(&CPU::LoadImmediate16ToReg, this, &reg_.HL);
-                break;
-            case 0x31:
-                instruction_ = std::bind(&CPU::LoadImmediate16ToReg, this, &reg_.SP);
-                break;
-
-            // LD SP, HL
-            case 0xF9:
-                instruction_ = std::bind(&CPU::LoadHLToSP, this);
-                break;
-
-            // LD HL, SP+n
-            case 0xF8:
-                instruction_ = std::bind(&CPU::LoadSPnToHL, this);
-                break;
-
-            // LD (nn), SP
-            case 0x08:
-                instruction_ = std::bind(&CPU::LoadSPToAbsoluteMem, this);
-                break;
-
-            // PUSH rr
-            case 0xF5:
-                instruction_ = std::bind(&CPU::PushReg16, this, reg_.AF);
-                break;
-            case 0xC5:
-                instruction_ = std::bind(&CPU::PushReg16, this, reg_.BC);
-                break;
-            case 0xD5:
-                instruction_ = std::bind(&CPU::PushReg16, this, reg_.DE);
-                break;
-            case 0xE5:
-                instruction_ = std::bind(&CPU::PushReg16, this, reg_.HL);
-                break;
-
-            // POP rr
-            case 0xF1:
-                instruction_ = std::bind(&CPU::PopReg16, this, &reg_.AF, true);
-                break;
-            case 0xC1:
-                instruction_ = std::bind(&CPU::PopReg16, this, &reg_.BC, false);
-                break;
-            case 0xD1:
-                instruction_ = std::bind(&CPU::PopReg16, this, &reg_.DE, false);
-                break;
-            case 0xE1:
-                instruction_ = std::bind(&CPU::PopReg16, this, &reg_.HL, false);
-                break;
-
             // ADD A, n
             case 0x87:
                 AddToReg(&reg_.A, reg_.A, false, false);
@@ -894,12 +678,6 @@ void CPU::DecodeOpCode()
             case 0x85:
                 AddToReg(&reg_.A, reg_.L, false, false);
                 break;
-            case 0x86:
-                instruction_ = std::bind(&CPU::AddMemToA, this, false, false);
-                break;
-            case 0xC6:
-                instruction_ = std::bind(&CPU::AddMemToA, this, true, false);
-                break;
 
             // ADC A, n
             case 0x8F:
@@ -923,12 +701,6 @@ void CPU::DecodeOpCode()
             case 0x8D:
                 AddToReg(&reg_.A, reg_.L, true, false);
                 break;
-            case 0x8E:
-                instruction_ = std::bind(&CPU::AddMemToA, this, false, true);
-                break;
-            case 0xCE:
-                instruction_ = std::bind(&CPU::AddMemToA, this, true, true);
-                break;
 
             // SUB A, n
             case 0x97:
@@ -952,12 +724,6 @@ void CPU::DecodeOpCode()
             case 0x95:
                 SubFromReg(&reg_.A, reg_.L, false, false, false);
                 break;
-            case 0x96:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, false, false, false);
-                break;
-            case 0xD6:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, true, false, false);
-                break;
 
             // SBC A, n
             case 0x9F:
@@ -981,12 +747,6 @@ void CPU::DecodeOpCode()
             case 0x9D:
                 SubFromReg(&reg_.A, reg_.L, true, false, false);
                 break;
-            case 0x9E:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, false, true, false);
-                break;
-            case 0xDE:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, true, true, false);
-                break;
 
             // AND A, n
             case 0xA7:
@@ -1010,12 +770,6 @@ void CPU::DecodeOpCode()
             case 0xA5:
                 AndWithA(reg_.L);
                 break;
-            case 0xA6:
-                instruction_ = std::bind(&CPU::AndMemWithA, this, false);
-                break;
-            case 0xE6:
-                instruction_ = std::bind(&CPU::AndMemWithA, this, true);
-                break;
 
             // OR A, n
             case 0xB7:
@@ -1039,12 +793,6 @@ void CPU::DecodeOpCode()
             case 0xB5:
                 OrWithA(reg_.L);
                 break;
-            case 0xB6:
-                instruction_ = std::bind(&CPU::OrMemWithA, this, false);
-                break;
-            case 0xF6:
-                instruction_ = std::bind(&CPU::OrMemWithA, this, true);
-                break;
 
             // XOR A, n
             case 0xAF:
@@ -1068,12 +816,6 @@ void CPU::DecodeOpCode()
             case 0xAD:
                 XorWithA(reg_.L);
                 break;
-            case 0xAE:
-                instruction_ = std::bind(&CPU::XorMemWithA, this, false);
-                break;
-            case 0xEE:
-                instruction_ = std::bind(&CPU::XorMemWithA, this, true);
-                break;
 
             // CP n
             case 0xBF:
@@ -1097,12 +839,6 @@ void CPU::DecodeOpCode()
             case 0xBD:
                 SubFromReg(&reg_.A, reg_.L, false, true, false);
                 break;
-            case 0xBE:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, false, false, true);
-                break;
-            case 0xFE:
-                instruction_ = std::bind(&CPU::SubMemFromA, this, true, false, true);
-                break;
 
             // INC n
             case 0x3C:
@@ -1126,9 +862,6 @@ void CPU::DecodeOpCode()
             case 0x2C:
                 AddToReg(&reg_.L, 1, false, true);
                 break;
-            case 0x34:
-                instruction_ = std::bind(&CPU::IncHL, this);
-                break;
 
             // DEC n
             case 0x3D:
@@ -1152,56 +885,6 @@ void CPU::DecodeOpCode()
             case 0x2D:
                 SubFromReg(&reg_.L, 1, false, false, true);
                 break;
-            case 0x35:
-                instruction_ = std::bind(&CPU::DecHL, this);
-                break;
-
-            // ADD HL, n
-            case 0x09:
-                instruction_ = std::bind(&CPU::AddRegToHL, this, reg_.BC);
-                break;
-            case 0x19:
-                instruction_ = std::bind(&CPU::AddRegToHL, this, reg_.DE);
-                break;
-            case 0x29:
-                instruction_ = std::bind(&CPU::AddRegToHL, this, reg_.HL);
-                break;
-            case 0x39:
-                instruction_ = std::bind(&CPU::AddRegToHL, this, reg_.SP);
-                break;
-
-            // ADD SP, n
-            case 0xE8:
-                instruction_ = std::bind(&CPU::AddImmediateToSP, this);
-                break;
-
-            // INC nn
-            case 0x03:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.BC, 1);
-                break;
-            case 0x13:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.DE, 1);
-                break;
-            case 0x23:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.HL, 1);
-                break;
-            case 0x33:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.SP, 1);
-                break;
-
-            // DEC nn
-            case 0x0B:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.BC, -1);
-                break;
-            case 0x1B:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.DE, -1);
-                break;
-            case 0x2B:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.HL, -1);
-                break;
-            case 0x3B:
-                instruction_ = std::bind(&CPU::IncDec16, this, &reg_.SP, -1);
-                break;
 
             // DAA
             case 0x27:
@@ -1277,120 +960,525 @@ void CPU::DecodeOpCode()
                 RR(&reg_.A, false);
                 break;
 
-            // JP nn
-            case 0xC3:
-                instruction_ = std::bind(&CPU::JumpToAbsolute, this, true);
-                break;
-
-            // JP cc, nn
-            case 0xC2:
-                instruction_ = std::bind(&CPU::JumpToAbsolute, this, !reg_.IsZeroFlagSet());
-                break;
-            case 0xCA:
-                instruction_ = std::bind(&CPU::JumpToAbsolute, this, reg_.IsZeroFlagSet());
-                break;
-            case 0xD2:
-                instruction_ = std::bind(&CPU::JumpToAbsolute, this, !reg_.IsCarryFlagSet());
-                break;
-            case 0xDA:
-                instruction_ = std::bind(&CPU::JumpToAbsolute, this, reg_.IsCarryFlagSet());
-                break;
-
             // JP HL
             case 0xE9:
                 reg_.PC = reg_.HL;
                 mCycle_ = 0;
                 break;
+        }
+    }
 
-            // JR n
-            case 0x18:
-                instruction_ = std::bind(&CPU::JumpToRelative, this, true);
+    prefixedInstruction_ = prefixedOpCode_;
+    prefixedOpCode_ = false;
+}
+
+void CPU::ExecuteInstruction()
+{
+    if (prefixedInstruction_)
+    {
+        switch (opCode_)
+        {
+            // SWAP (HL)
+            case 0x36:
+                SwapMemNibbles();
                 break;
 
-            // JR cc,n
-            case 0x20:
-                instruction_ = std::bind(&CPU::JumpToRelative, this, !reg_.IsZeroFlagSet());
+            // RLC (HL)
+            case 0x06:
+                RLCMem();
+                break;
+
+            // RL (HL)
+            case 0x16:
+                RLMem();
+                break;
+
+            // RRC (HL)
+            case 0x0E:
+                RRCMem();
+                break;
+
+            // RR (HL)
+            case 0x1E:
+                RRMem();
+                break;
+
+            // SLA (HL)
+            case 0x26:
+                SLAMem();
+                break;
+
+            // SRA (HL)
+            case 0x2E:
+                SRAMem();
+                break;
+
+            // SRL (HL)
+            case 0x3E:
+                SRLMem();
+                break;
+
+            // BIT b, (HL)
+            case 0x46:
+            case 0x4E:
+            case 0x56:
+            case 0x5E:
+            case 0x66:
+            case 0x6E:
+            case 0x76:
+            case 0x7E:
+                BitMem((opCode_ & 0x38) >> 3);
+                break;
+
+            // SET b, (HL)
+            case 0xC6:
+            case 0xCE:
+            case 0xD6:
+            case 0xDE:
+            case 0xE6:
+            case 0xEE:
+            case 0xF6:
+            case 0xFE:
+                SetMem((opCode_ & 0x38) >> 3);
+                break;
+
+            // RES b, (HL)
+            case 0x86:
+            case 0x8E:
+            case 0x96:
+            case 0x9E:
+            case 0xA6:
+            case 0xAE:
+            case 0xB6:
+            case 0xBE:
+                ResMem((opCode_ & 0x38) >> 3);
+                break;
+        }
+    }
+    else
+    {
+        switch (opCode_)
+        {
+            // LD r, n
+            case 0x3E:
+                LoadImmediateToReg(&reg_.A);
+                break;
+            case 0x06:
+                LoadImmediateToReg(&reg_.B);
+                break;
+            case 0x0E:
+                LoadImmediateToReg(&reg_.C);
+                break;
+            case 0x16:
+                LoadImmediateToReg(&reg_.D);
+                break;
+            case 0x1E:
+                LoadImmediateToReg(&reg_.E);
+                break;
+            case 0x26:
+                LoadImmediateToReg(&reg_.H);
+                break;
+            case 0x2E:
+                LoadImmediateToReg(&reg_.L);
+                break;
+
+            // LD (nn), r
+            case 0x02:
+                LoadRegToMem(reg_.BC, reg_.A);
+                break;
+            case 0x12:
+                LoadRegToMem(reg_.DE, reg_.A);
+                break;
+            case 0x77:
+                LoadRegToMem(reg_.HL, reg_.A);
+                break;
+            case 0xEA:
+                LoadRegToAbsoluteMem(reg_.A);
+                break;
+            case 0x70:
+                LoadRegToMem(reg_.HL, reg_.B);
+                break;
+            case 0x71:
+                LoadRegToMem(reg_.HL, reg_.C);
+                break;
+            case 0x72:
+                LoadRegToMem(reg_.HL, reg_.D);
+                break;
+            case 0x73:
+                LoadRegToMem(reg_.HL, reg_.E);
+                break;
+            case 0x74:
+                LoadRegToMem(reg_.HL, reg_.H);
+                break;
+            case 0x75:
+                LoadRegToMem(reg_.HL, reg_.L);
+                break;
+            case 0x36:
+                LoadImmediateToMem(reg_.HL);
+                break;
+
+            // LD r, (nn)
+            case 0x7E:
+                LoadMemToReg(&reg_.A, reg_.HL);
+                break;
+            case 0x0A:
+                LoadMemToReg(&reg_.A, reg_.BC);
+                break;
+            case 0x1A:
+                LoadMemToReg(&reg_.A, reg_.DE);
+                break;
+            case 0xFA:
+                LoadAbsoluteMemToReg(&reg_.A);
+                break;
+            case 0x46:
+                LoadMemToReg(&reg_.B, reg_.HL);
+                break;
+            case 0x4E:
+                LoadMemToReg(&reg_.C, reg_.HL);
+                break;
+            case 0x56:
+                LoadMemToReg(&reg_.D, reg_.HL);
+                break;
+            case 0x5E:
+                LoadMemToReg(&reg_.E, reg_.HL);
+                break;
+            case 0x66:
+                LoadMemToReg(&reg_.H, reg_.HL);
+                break;
+            case 0x6E:
+                LoadMemToReg(&reg_.L, reg_.HL);
+                break;
+
+            // LD A, ($FF00+C)
+            case 0xF2:
+                LoadMemToReg(&reg_.A, 0xFF00 + reg_.C);
+                break;
+
+            // LD ($FF00+C), A
+            case 0xE2:
+                LoadRegToMem(0xFF00 + reg_.C, reg_.A);
+                break;
+
+            // LD A, ($FF00+n)
+            case 0xF0:
+                LoadLastPageToReg();
+                break;
+
+            // LD ($FF00+n), A
+            case 0xE0:
+                LoadRegToLastPage();
+                break;
+
+            // LDD A, (HL)
+            case 0x3A:
+                LoadMemToRegPostfix(false);
+                break;
+
+            // LDD (HL), A
+            case 0x32:
+                LoadRegToMemPostfix(false);
+                break;
+
+            // LDI A, (HL)
+            case 0x2A:
+                LoadMemToRegPostfix(true);
+                break;
+
+            // LDI (HL), A
+            case 0x22:
+                LoadRegToMemPostfix(true);
+                break;
+
+            // LD rr, nn
+            case 0x01:
+                LoadImmediate16ToReg(&reg_.BC);
+                break;
+            case 0x11:
+                LoadImmediate16ToReg(&reg_.DE);
+                break;
+            case 0x21:
+                LoadImmediate16ToReg(&reg_.HL);
+                break;
+            case 0x31:
+                LoadImmediate16ToReg(&reg_.SP);
+                break;
+
+            // LD SP, HL
+            case 0xF9:
+                LoadHLToSP();
+                break;
+
+            // LD HL, SP+n
+            case 0xF8:
+                LoadSPnToHL();
+                break;
+
+            // LD (nn), SP
+            case 0x08:
+                LoadSPToAbsoluteMem();
+                break;
+
+            // PUSH rr
+            case 0xF5:
+                PushReg16(reg_.AF);
+                break;
+            case 0xC5:
+                PushReg16(reg_.BC);
+                break;
+            case 0xD5:
+                PushReg16(reg_.DE);
+                break;
+            case 0xE5:
+                PushReg16(reg_.HL);
+                break;
+
+            // POP rr
+            case 0xF1:
+                PopReg16(&reg_.AF, true);
+                break;
+            case 0xC1:
+                PopReg16(&reg_.BC, false);
+                break;
+            case 0xD1:
+                PopReg16(&reg_.DE, false);
+                break;
+            case 0xE1:
+                PopReg16(&reg_.HL, false);
+                break;
+
+            // ADD A, n
+            case 0x86:
+                AddMemToA(false, false);
+                break;
+            case 0xC6:
+                AddMemToA(true, false);
+                break;
+
+            // ADC A, n
+            case 0x8E:
+                AddMemToA(false, true);
+                break;
+            case 0xCE:
+                AddMemToA(true, true);
+                break;
+
+            // SUB A, n
+            case 0x96:
+                SubMemFromA(false, false, false);
+                break;
+            case 0xD6:
+                SubMemFromA(true, false, false);
+                break;
+
+            // SBC A, n
+            case 0x9E:
+                SubMemFromA(false, true, false);
+                break;
+            case 0xDE:
+                SubMemFromA(true, true, false);
+                break;
+
+            // AND A, n
+            case 0xA6:
+                AndMemWithA(false);
+                break;
+            case 0xE6:
+                AndMemWithA(true);
+                break;
+
+            // OR A, n
+            case 0xB6:
+                OrMemWithA(false);
+                break;
+            case 0xF6:
+                OrMemWithA(true);
+                break;
+
+            // XOR A, n
+            case 0xAE:
+                XorMemWithA(false);
+                break;
+            case 0xEE:
+                XorMemWithA(true);
+                break;
+
+            // CP n
+            case 0xBE:
+                SubMemFromA(false, false, true);
+                break;
+            case 0xFE:
+                SubMemFromA(true, false, true);
+                break;
+
+            // INC n
+            case 0x34:
+                IncHL();
+                break;
+
+            // DEC n
+            case 0x35:
+                DecHL();
+                break;
+
+            // ADD HL, n
+            case 0x09:
+                AddRegToHL(reg_.BC);
+                break;
+            case 0x19:
+                AddRegToHL(reg_.DE);
+                break;
+            case 0x29:
+                AddRegToHL(reg_.HL);
+                break;
+            case 0x39:
+                AddRegToHL(reg_.SP);
+                break;
+
+            // ADD SP, n
+            case 0xE8:
+                AddImmediateToSP();
+                break;
+
+            // INC nn
+            case 0x03:
+                IncDec16(&reg_.BC, 1);
+                break;
+            case 0x13:
+                IncDec16(&reg_.DE, 1);
+                break;
+            case 0x23:
+                IncDec16(&reg_.HL, 1);
+                break;
+            case 0x33:
+                IncDec16(&reg_.SP, 1);
+                break;
+
+            // DEC nn
+            case 0x0B:
+                IncDec16(&reg_.BC, -1);
+                break;
+            case 0x1B:
+                IncDec16(&reg_.DE, -1);
+                break;
+            case 0x2B:
+                IncDec16(&reg_.HL, -1);
+                break;
+            case 0x3B:
+                IncDec16(&reg_.SP, -1);
+                break;
+
+            // JP nn
+            case 0xC3:
+                JumpToAbsolute(true);
+                break;
+
+            // JP cc, nn
+            case 0xC2:
+                JumpToAbsolute(!reg_.IsZeroFlagSet());
+                break;
+            case 0xCA:
+                JumpToAbsolute(reg_.IsZeroFlagSet());
+                break;
+            case 0xD2:
+                JumpToAbsolute(!reg_.IsCarryFlagSet());
+                break;
+            case 0xDA:
+                JumpToAbsolute(reg_.IsCarryFlagSet());
+                break;
+
+            // JR n
+            case 0x18:
+                JumpToRelative(true);
+                break;
+
+            // JR cc,n
+            case 0x20:
+                JumpToRelative(!reg_.IsZeroFlagSet());
                 break;
             case 0x28:
-                instruction_ = std::bind(&CPU::JumpToRelative, this, reg_.IsZeroFlagSet());
+                JumpToRelative(reg_.IsZeroFlagSet());
                 break;
             case 0x30:
-                instruction_ = std::bind(&CPU::JumpToRelative, this, !reg_.IsCarryFlagSet());
+                JumpToRelative(!reg_.IsCarryFlagSet());
                 break;
             case 0x38:
-                instruction_ = std::bind(&CPU::JumpToRelative, this, reg_.IsCarryFlagSet());
+                JumpToRelative(reg_.IsCarryFlagSet());
                 break;
 
             // CALL nn
             case 0xCD:
-                instruction_ = std::bind(&CPU::Call, this, true);
+                Call(true);
                 break;
 
             // CALL cc,nn
             case 0xC4:
-                instruction_ = std::bind(&CPU::Call, this, !reg_.IsZeroFlagSet());
+                Call(!reg_.IsZeroFlagSet());
                 break;
             case 0xCC:
-                instruction_ = std::bind(&CPU::Call, this, reg_.IsZeroFlagSet());
+                Call(reg_.IsZeroFlagSet());
                 break;
             case 0xD4:
-                instruction_ = std::bind(&CPU::Call, this, !reg_.IsCarryFlagSet());
+                Call(!reg_.IsCarryFlagSet());
                 break;
             case 0xDC:
-                instruction_ = std::bind(&CPU::Call, this, reg_.IsCarryFlagSet());
+                Call(reg_.IsCarryFlagSet());
                 break;
 
             // RST n
             case 0xC7:
-                instruction_ = std::bind(&CPU::Restart, this, 0x00);
+                Restart(0x00);
                 break;
             case 0xCF:
-                instruction_ = std::bind(&CPU::Restart, this, 0x08);
+                Restart(0x08);
                 break;
             case 0xD7:
-                instruction_ = std::bind(&CPU::Restart, this, 0x10);
+                Restart(0x10);
                 break;
             case 0xDF:
-                instruction_ = std::bind(&CPU::Restart, this, 0x18);
+                Restart(0x18);
                 break;
             case 0xE7:
-                instruction_ = std::bind(&CPU::Restart, this, 0x20);
+                Restart(0x20);
                 break;
             case 0xEF:
-                instruction_ = std::bind(&CPU::Restart, this, 0x28);
+                Restart(0x28);
                 break;
             case 0xF7:
-                instruction_ = std::bind(&CPU::Restart, this, 0x30);
+                Restart(0x30);
                 break;
             case 0xFF:
-                instruction_ = std::bind(&CPU::Restart, this, 0x38);
+                Restart(0x38);
                 break;
 
             // RET
             case 0xC9:
-                instruction_ = std::bind(&CPU::Return, this, false);
+                Return(false);
                 break;
 
             // RET cc
             case 0xC0:
-                instruction_ = std::bind(&CPU::ReturnConditional, this, !reg_.IsZeroFlagSet());
+                ReturnConditional(!reg_.IsZeroFlagSet());
                 break;
             case 0xC8:
-                instruction_ = std::bind(&CPU::ReturnConditional, this, reg_.IsZeroFlagSet());
+                ReturnConditional(reg_.IsZeroFlagSet());
                 break;
             case 0xD0:
-                instruction_ = std::bind(&CPU::ReturnConditional, this, !reg_.IsCarryFlagSet());
+                ReturnConditional(!reg_.IsCarryFlagSet());
                 break;
             case 0xD8:
-                instruction_ = std::bind(&CPU::ReturnConditional, this, reg_.IsCarryFlagSet());
+                ReturnConditional(reg_.IsCarryFlagSet());
                 break;
 
             // RETI
             case 0xD9:
-                instruction_ = std::bind(&CPU::Return, this, true);
+                Return(true);
+                break;
+
+            // Illegal opcodes lock up the CPU.
+            default:
+                mCycle_ = 1;
+                locked_ = true;
                 break;
         }
     }
-
-    prefixedOpCode_ = false;
 }
@@ -1,4 +1,5 @@
 #include <CPU.hpp>
+#include <GameBoy.hpp>
 #include <cstdint>
 
 void CPU::InterruptHandler(uint16_t addr)
@@ -0,0 +1,26 @@
+#include <Cartridge/Cartridge.hpp>
+#include <Cartridge/RomImage.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+void Cartridge::LoadROM(std::shared_ptr<RomImage const> rom, uint16_t const romBankCount)
+{
+    size_t const romSize = romBankCount * ROM_BANK_SIZE;
+    romImage_ = std::move(rom);
+
+    if (romImage_->Size() >= romSize)
+    {
+        ROM_ = romImage_->Data();
+    }
+    else
+    {
+        paddedROM_.assign(romSize, 0x00);
+        std::copy_n(romImage_->Data(), romImage_->Size(), paddedROM_.begin());
+        ROM_ = paddedROM_.data();
+    }
+
+    MapRomBanks(0, 1);
+}
@@ -1,5 +1,4 @@
 #include <Cartridge/MBC0.hpp>
-#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <filesystem>
@@ -7,8 +6,7 @@
 
 namespace fs = std::filesystem;
 
-MBC0::MBC0(std::array<uint8_t, 0x4000> const& bank0,
-           std::ifstream& rom,
+MBC0::MBC0(std::shared_ptr<RomImage const> rom,
            fs::path savePath,
            uint8_t cartridgeType,
            uint8_t ramBankCount)
@@ -17,8 +15,7 @@ MBC0::MBC0(std::array<uint8_t, 0x4000> const& bank0,
     batteryBacked_ = (cartridgeType == 0x09);
     containsRAM_ = (ramBankCount > 0);
 
-    std::copy(bank0.begin(), bank0.end(), ROM_[0].begin());
-    rom.read(reinterpret_cast<char*>(ROM_[1].data()), 0x4000);
+    LoadROM(rom, 2);
     RAM_.fill(0x00);
 
     if (batteryBacked_ && !savePath_.empty())
@@ -46,19 +43,10 @@ void MBC0::Reset()
 
 }
 
-uint8_t MBC0::ReadROM(uint16_t addr)
-{
-    if (addr < 0x4000)
-    {
-        return ROM_[0][addr];
-    }
-
-    return ROM_[1][addr - 0x4000];
-}
-
-void MBC0::WriteROM(uint16_t addr, uint8_t data)
+uint8_t MBC0::WriteROM(uint16_t addr, uint8_t data)
 {
     (void)addr; (void)data;
+    return BankChange::NONE;
 }
 
 uint8_t MBC0::ReadRAM(uint16_t addr)
@@ -79,6 +67,16 @@ void MBC0::WriteRAM(uint16_t addr, uint8_t data)
     }
 }
 
+uint8_t const* MBC0::MappedRamReadBank() const
+{
+    return containsRAM_ ? RAM_.data() : nullptr;
+}
+
+uint8_t* MBC0::MappedRamWriteBank()
+{
+    return containsRAM_ ? RAM_.data() : nullptr;
+}
+
 void MBC0::SaveRAM()
 {
     if (batteryBacked_ && !savePath_.empty())
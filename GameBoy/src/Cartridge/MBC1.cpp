@@ -1,5 +1,4 @@
 #include <Cartridge/MBC1.hpp>
-#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <filesystem>
@@ -7,8 +6,7 @@
 
 namespace fs = std::filesystem;
 
-MBC1::MBC1(std::array<uint8_t, 0x4000> const& bank0,
-           std::ifstream& rom,
+MBC1::MBC1(std::shared_ptr<RomImage const> rom,
            fs::path savePath,
            uint8_t cartridgeType,
            uint16_t romBanks,
@@ -21,16 +19,9 @@ MBC1::MBC1(std::array<uint8_t, 0x4000> const& bank0,
     ramBankCount_ = ramBanks;
     largeCart_ = (ramBanks > 32);
 
-    ROM_.resize(romBanks);
+    LoadROM(rom, romBanks);
     RAM_.resize(ramBanks);
 
-    std::copy(bank0.begin(), bank0.end(), ROM_[0].begin());
-
-    for (size_t i = 1; i < ROM_.size(); ++i)
-    {
-        rom.read(reinterpret_cast<char*>(ROM_[i].data()), 0x4000);
-    }
-
     if (batteryBacked_ && !savePath_.empty())
     {
         std::ifstream save(savePath_, std::ios::binary);
@@ -74,48 +65,34 @@ void MBC1::Reset()
     romBank_ = 1;
     ramBank_ = 0;
     advancedBankMode_ = false;
+    UpdateRomBanks();
 }
 
-uint8_t MBC1::ReadROM(uint16_t addr)
+void MBC1::UpdateRomBanks()
 {
-    if (addr < 0x4000)
+    uint_fast16_t lowerBank = 0;
+    uint_fast16_t upperBank = romBank_;
+
+    if (largeCart_)
     {
-        if (advancedBankMode_ && largeCart_)
+        if (advancedBankMode_)
         {
-            uint_fast8_t bank = ramBank_ * 0x20;
-            bank %= romBankCount_;
-            return ROM_[bank][addr];
+            lowerBank = (ramBank_ * 0x20) % romBankCount_;
         }
-        else
-        {
-            return ROM_[0][addr];
-        }
-    }
-    else
-    {
-        addr -= 0x4000;
 
-        if (largeCart_)
-        {
-            uint_fast16_t fullAddr = (ramBank_ << 19) | (romBank_ << 9) | addr;
-            uint_fast16_t bank = fullAddr / 0x4000;
-            bank %= romBankCount_;
-            return ROM_[bank][addr];
-        }
-        else
-        {
-            return ROM_[romBank_][addr];
-        }
+        uint_fast16_t fullAddr = (ramBank_ << 19) | (romBank_ << 9);
+        upperBank = (fullAddr / 0x4000) % romBankCount_;
     }
 
-    return 0xFF;
+    MapRomBanks(lowerBank, upperBank);
 }
 
-void MBC1::WriteROM(uint16_t addr, uint8_t data)
+uint8_t MBC1::WriteROM(uint16_t addr, uint8_t data)
 {
     if (addr < 0x2000)
     {
         ramEnabled_ = ((data & 0x0A) == 0x0A);
+        return BankChange::RAM;
     }
     else if (addr < 0x4000)
     {
@@ -129,15 +106,34 @@ void MBC1::WriteROM(uint16_t addr, uint8_t data)
         {
             romBank_ = maskedBankNum;
         }
+
+        UpdateRomBanks();
+        return BankChange::ROM_X;
     }
     else if (addr < 0x6000)
     {
         ramBank_ = data & 0x03;
+
+        if (!largeCart_)
+        {
+            return BankChange::RAM;
+        }
+
+        // On large carts this register also holds the upper ROM bank bits, which select bank 0 too in advanced mode.
+        UpdateRomBanks();
+        return advancedBankMode_ ? (BankChange::ROM_0 | BankChange::ROM_X | BankChange::RAM)
+                                 : (BankChange::ROM_X | BankChange::RAM);
     }
-    else
+
+    advancedBankMode_ = (data & 0x01);
+
+    if (!largeCart_)
     {
-        advancedBankMode_ = (data & 0x01);
+        return BankChange::RAM;
     }
+
+    UpdateRomBanks();
+    return BankChange::ROM_0 | BankChange::RAM;
 }
 
 uint8_t MBC1::ReadRAM(uint16_t addr)
@@ -176,6 +172,31 @@ void MBC1::WriteRAM(uint16_t addr, uint8_t data)
     }
 }
 
+uint8_t const* MBC1::MappedRamReadBank() const
+{
+    if (containsRAM_ && ramEnabled_)
+    {
+        if (!advancedBankMode_ || (advancedBankMode_ && largeCart_) || (ramBankCount_ == 1))
+        {
+            return RAM_[0].data();
+        }
+
+        return RAM_[ramBank_].data();
+    }
+
+    return nullptr;
+}
+
+uint8_t* MBC1::MappedRamWriteBank()
+{
+    if (containsRAM_ && ramEnabled_)
+    {
+        return (ramBankCount_ == 1) ? RAM_[0].data() : RAM_[ramBank_].data();
+    }
+
+    return nullptr;
+}
+
 void MBC1::SaveRAM()
 {
     if (batteryBacked_ && !savePath_.empty())
@@ -216,4 +237,5 @@ void MBC1::Deserialize(std::ifstream& in)
     in.read(reinterpret_cast<char*>(&romBank_), sizeof(romBank_));
     in.read(reinterpret_cast<char*>(&ramBank_), sizeof(ramBank_));
     in.read(reinterpret_cast<char*>(&advancedBankMode_), sizeof(advancedBankMode_));
+    UpdateRomBanks();
 }
@@ -6,8 +6,7 @@
 #include <fstream>
 #include <vector>
 
-MBC3::MBC3(std::array<uint8_t, 0x4000> const& bank0,
-         std::ifstream& rom,
+MBC3::MBC3(std::shared_ptr<RomImage const> rom,
          fs::path savePath,
          uint8_t cartridgeType,
          uint16_t romBankCount,
@@ -20,16 +19,9 @@ MBC3::MBC3(std::array<uint8_t, 0x4000> const& bank0,
     containsRTC_ = (cartridgeType == 0x0F) || (cartridgeType == 0x10);
     containsRAM_ = ramBankCount > 0;
 
-    ROM_.resize(romBankCount);
+    LoadROM(rom, romBankCount);
     RAM_.resize(ramBankCount);
 
-    std::copy(bank0.begin(), bank0.end(), ROM_[0].begin());
-
-    for (size_t i = 1; i < ROM_.size(); ++i)
-    {
-        rom.read(reinterpret_cast<char*>(ROM_[i].data()), 0x4000);
-    }
-
     if (batteryBacked_ && !savePath_.empty())
     {
         std::ifstream save(savePath_, std::ios::binary);
@@ -93,25 +85,20 @@ void MBC3::Reset()
     DH_ = 0x00;
 
     latchInitiated_ = false;
+    UpdateRomBanks();
 }
 
-uint8_t MBC3::ReadROM(uint16_t addr)
+void MBC3::UpdateRomBanks()
 {
-    if (addr < 0x4000)
-    {
-        return ROM_[0][addr];
-    }
-    else
-    {
-        return ROM_[romBank_][addr - 0x4000];
-    }
+    MapRomBanks(0, romBank_);
 }
 
-void MBC3::WriteROM(uint16_t addr, uint8_t data)
+uint8_t MBC3::WriteROM(uint16_t addr, uint8_t data)
 {
     if (addr < 0x2000)
     {
         ramEnabled_ = ((data & 0x0A) == 0x0A);
+        return BankChange::RAM;
     }
     else if (addr < 0x4000)
     {
@@ -121,6 +108,9 @@ void MBC3::WriteROM(uint16_t addr, uint8_t data)
         {
             romBank_ = 0x01;
         }
+
+        UpdateRomBanks();
+        return BankChange::ROM_X;
     }
     else if (addr < 0x6000)
     {
@@ -135,12 +125,14 @@ void MBC3::WriteROM(uint16_t addr, uint8_t data)
         {
             ramBank_ = data;
         }
+
+        return BankChange::RAM;
     }
     else
     {
         if (!containsRTC_)
         {
-            return;
+            return BankChange::NONE;
         }
         else if (!data && !latchInitiated_)
         {
@@ -162,6 +154,8 @@ void MBC3::WriteROM(uint16_t addr, uint8_t data)
             DH_ = DH_internal_;
         }
     }
+
+    return BankChange::NONE;
 }
 
 uint8_t MBC3::ReadRAM(uint16_t addr)
@@ -250,6 +244,27 @@ void MBC3::WriteRAM(uint16_t addr, uint8_t data)
     }
 }
 
+uint8_t const* MBC3::MappedRamReadBank() const
+{
+    // RTC registers are mapped in when a bank above 0x03 is selected, so those reads go through ReadRAM.
+    if (ramEnabled_ && containsRAM_ && (ramBank_ < 0x04))
+    {
+        return RAM_[ramBank_].data();
+    }
+
+    return nullptr;
+}
+
+uint8_t* MBC3::MappedRamWriteBank()
+{
+    if (ramEnabled_ && containsRAM_ && (ramBank_ < 0x04))
+    {
+        return RAM_[ramBank_].data();
+    }
+
+    return nullptr;
+}
+
 void MBC3::SaveRAM()
 {
     if (batteryBacked_ && !savePath_.empty())
@@ -343,6 +358,8 @@ void MBC3::Deserialize(std::ifstream& in)
         in.read(reinterpret_cast<char*>(&serializedTime), sizeof(serializedTime));
         referencePoint_ = std::chrono::system_clock::time_point{std::chrono::system_clock::duration{serializedTime}};
     }
+
+    UpdateRomBanks();
 }
 
 void MBC3::UpdateInternalRTC()
@@ -1,5 +1,4 @@
 #include <Cartridge/MBC5.hpp>
-#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <filesystem>
@@ -7,8 +6,7 @@
 
 namespace fs = std::filesystem;
 
-MBC5::MBC5(std::array<uint8_t, 0x4000> const& bank0,
-           std::ifstream& rom,
+MBC5::MBC5(std::shared_ptr<RomImage const> rom,
            fs::path savePath,
            uint8_t cartridgeType,
            uint16_t romBankCount,
@@ -20,16 +18,9 @@ MBC5::MBC5(std::array<uint8_t, 0x4000> const& bank0,
     batteryBacked_ = (cartridgeType == 0x1B) || (cartridgeType == 0x1E);
     containsRAM_ = ramBankCount > 0;
 
-    ROM_.resize(romBankCount);
+    LoadROM(rom, romBankCount);
     RAM_.resize(ramBankCount);
 
-    std::copy(bank0.begin(), bank0.end(), ROM_[0].begin());
-
-    for (size_t i = 1; i < ROM_.size(); ++i)
-    {
-        rom.read(reinterpret_cast<char*>(ROM_[i].data()), 0x4000);
-    }
-
     if (batteryBacked_ && !savePath_.empty())
     {
         std::ifstream save(savePath_, std::ios::binary);
@@ -65,25 +56,20 @@ void MBC5::Reset()
     romBankLsb_ = 0x01;
     romBankMsb_ = 0x00;
     ramBank_ = 0x00;
+    UpdateRomBanks();
 }
 
-uint8_t MBC5::ReadROM(uint16_t addr)
+void MBC5::UpdateRomBanks()
 {
-    if (addr < 0x4000)
-    {
-        return ROM_[0][addr];
-    }
-    else
-    {
-        return ROM_[romBankIndex_][addr - 0x4000];
-    }
+    MapRomBanks(0, romBankIndex_);
 }
 
-void MBC5::WriteROM(uint16_t addr, uint8_t data)
+uint8_t MBC5::WriteROM(uint16_t addr, uint8_t data)
 {
     if (addr < 0x2000)
     {
         ramEnabled_ = (data & 0x0A) == 0x0A;
+        return BankChange::RAM;
     }
     else if (addr < 0x4000)
     {
@@ -97,11 +83,16 @@ void MBC5::WriteROM(uint16_t addr, uint8_t data)
         }
 
         romBankIndex_ = (((romBankMsb_ & 0x01) << 8) | romBankLsb_) % romBankCount_;
+        UpdateRomBanks();
+        return BankChange::ROM_X;
     }
     else if (containsRAM_ && (addr < 0x6000))
     {
         ramBank_ = data % ramBankCount_;
+        return BankChange::RAM;
     }
+
+    return BankChange::NONE;
 }
 
 uint8_t MBC5::ReadRAM(uint16_t addr)
@@ -122,6 +113,16 @@ void MBC5::WriteRAM(uint16_t addr, uint8_t data)
     }
 }
 
+uint8_t const* MBC5::MappedRamReadBank() const
+{
+    return (containsRAM_ && ramEnabled_) ? RAM_[ramBank_].data() : nullptr;
+}
+
+uint8_t* MBC5::MappedRamWriteBank()
+{
+    return (containsRAM_ && ramEnabled_) ? RAM_[ramBank_].data() : nullptr;
+}
+
 void MBC5::SaveRAM()
 {
     if (batteryBacked_ && !savePath_.empty())
@@ -164,4 +165,5 @@ void MBC5::Deserialize(std::ifstream& in)
     in.read(reinterpret_cast<char*>(&romBankLsb_), sizeof(romBankLsb_));
     in.read(reinterpret_cast<char*>(&romBankMsb_), sizeof(romBankMsb_));
     in.read(reinterpret_cast<char*>(&ramBank_), sizeof(ramBank_));
+    UpdateRomBanks();
 }
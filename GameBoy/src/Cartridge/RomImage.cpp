@@ -0,0 +1,161 @@
+#include <Cartridge/RomImage.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/// @brief Build the key that identifies a ROM file in the cache. The size and modification time are included so that a ROM
+///        that's rebuilt in place is loaded again rather than served from a stale image.
+static std::string CacheKey(fs::path const& romPath)
+{
+    std::error_code ec;
+    fs::path path = fs::canonical(romPath, ec);
+
+    if (ec)
+    {
+        path = fs::absolute(romPath, ec);
+    }
+
+    auto const size = fs::file_size(romPath, ec);
+    auto const writeTime = fs::last_write_time(romPath, ec).time_since_epoch().count();
+
+    return path.string() + '|' + std::to_string(size) + '|' + std::to_string(writeTime);
+}
+
+std::shared_ptr<RomImage const> RomImage::Open(fs::path const& romPath)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::weak_ptr<RomImage const>> cache;
+
+    std::string const key = CacheKey(romPath);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto cached = cache.find(key);
+
+    if (cached != cache.end())
+    {
+        if (auto image = cached->second.lock())
+        {
+            return image;
+        }
+    }
+
+    std::shared_ptr<RomImage> image(new RomImage());
+
+    if (!image->Load(romPath))
+    {
+        return nullptr;
+    }
+
+    // Drop entries for images that are no longer in use.
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        it = it->second.expired() ? cache.erase(it) : std::next(it);
+    }
+
+    cache[key] = image;
+    return image;
+}
+
+RomImage::~RomImage()
+{
+    if (!mapped_)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+bool RomImage::Load(fs::path const& romPath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(romPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+
+        if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+        {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (mapping)
+            {
+                void const* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+
+                if (view)
+                {
+                    data_ = static_cast<uint8_t const*>(view);
+                    size_ = static_cast<size_t>(fileSize.QuadPart);
+                    mapped_ = true;
+                }
+            }
+        }
+
+        CloseHandle(file);
+    }
+#else
+    int fd = open(romPath.c_str(), O_RDONLY);
+
+    if (fd >= 0)
+    {
+        struct stat fileStat;
+
+        if ((fstat(fd, &fileStat) == 0) && (fileStat.st_size > 0))
+        {
+            void* view = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (view != MAP_FAILED)
+            {
+                data_ = static_cast<uint8_t const*>(view);
+                size_ = static_cast<size_t>(fileStat.st_size);
+                mapped_ = true;
+            }
+        }
+
+        close(fd);
+    }
+#endif
+
+    if (mapped_)
+    {
+        return true;
+    }
+
+    // Fall back to reading the whole file.
+    std::ifstream rom(romPath, std::ios::binary | std::ios::ate);
+
+    if (rom.fail())
+    {
+        return false;
+    }
+
+    buffer_.resize(static_cast<size_t>(rom.tellg()));
+    rom.seekg(0);
+    rom.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return size_ > 0;
+}
@@ -0,0 +1,33 @@
+#include <FrameBuffers.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+FrameBuffers::FrameBuffers(size_t const frameSize) :
+    middle_(1),
+    back_(0),
+    front_(2),
+    acquired_(false)
+{
+    for (auto& buffer : buffers_)
+    {
+        buffer.resize(frameSize, 0xFF);
+    }
+}
+
+uint8_t* FrameBuffers::Publish()
+{
+    back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    return buffers_[back_].data();
+}
+
+uint8_t const* FrameBuffers::Acquire()
+{
+    if (!acquired_ && (middle_.load(std::memory_order_relaxed) & FRESH))
+    {
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    acquired_ = true;
+    return buffers_[front_].data();
+}
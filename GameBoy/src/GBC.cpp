@@ -1,87 +1,422 @@
 #include <GBC.hpp>
+#include <AudioRingBuffer.hpp>
+#include <BatchRunner.hpp>
+#include <FrameBuffers.hpp>
 #include <GameBoy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <memory>
-
-std::unique_ptr<GameBoy> gb = std::make_unique<GameBoy>();
-void (*frameUpdateCallback)() = nullptr;
+#include <mutex>
+#include <thread>
+#include <vector>
 
 static constexpr int CPU_CLOCK_FREQUENCY = 1048576;
+static constexpr size_t FRAME_BUFFER_SIZE = 160 * 144 * 4;  // Large enough for any pixel format
+
+static_assert(static_cast<int>(PixelFormat::INDEXED8) == GBC_PIXEL_FORMAT_INDEXED8, "Pixel formats must match GBC.hpp");
+
+// The emulation thread runs in chunks of this many stereo samples, and keeps the audio ring buffer topped up to the target
+// fill. The target needs to cover a couple of audio callbacks' worth of samples plus however long the thread oversleeps.
+static constexpr int AUDIO_CHUNK_SIZE = 128;
+static constexpr int AUDIO_TARGET_FILL = 1536;
+static constexpr int AUDIO_RING_CAPACITY = 8192;
+static constexpr auto EMULATION_THREAD_SLEEP = std::chrono::milliseconds(1);
+
+// When pacing to the display instead, one refresh interval is run at a time. If the display runs within MAX_VSYNC_SKEW of the
+// Game Boy's ~59.73 Hz, emulation is sped up or slowed down to exactly one frame per refresh. The number of audio samples
+// produced each interval is adjusted by up to MAX_RATE_ADJUSTMENT to hold the ring buffer at AUDIO_TARGET_LATENCY seconds
+// of audio, measured just before each interval's samples are added.
+static constexpr double MAX_VSYNC_SKEW = 0.01;
+static constexpr double MAX_RATE_ADJUSTMENT = 0.005;
+static constexpr double AUDIO_TARGET_LATENCY = 0.02;
+static constexpr int MAX_VSYNC_LAG = 3;  // Refresh intervals to fall behind by before giving up on catching up
+
+struct GBC_Instance
+{
+    std::unique_ptr<GameBoy> gb = std::make_unique<GameBoy>();
+    void (*frameUpdateCallback)(void*) = nullptr;
+    void* callbackUserData = nullptr;
 
-static int SAMPLE_RATE = 44100;
-static float SAMPLE_PERIOD = 1.0 / SAMPLE_RATE;
-static int EMULATED_CPU_FREQUENCY = CPU_CLOCK_FREQUENCY;
-static float CPU_CLOCK_PERIOD = 1.0 / EMULATED_CPU_FREQUENCY;
+    // Frames owned by the library, used unless the caller provides its own frame buffer
+    FrameBuffers frames = FrameBuffers(FRAME_BUFFER_SIZE);
+    bool ownsFrames = false;
 
-// Save states
-bool createSaveState = false;
-bool loadSaveState = false;
-std::filesystem::path saveStatePathFS = "";
+    int sampleRate = 44100;
+    float samplePeriod = 1.0 / sampleRate;
+    int emulatedCpuFrequency = CPU_CLOCK_FREQUENCY;
+    float cpuClockPeriod = 1.0 / emulatedCpuFrequency;
+    int sampleDecimation = 1;
 
+    // Machine cycles run since power on
+    uint64_t cycleCount = 0;
 
-void Initialize(uint8_t* frameBuffer, void(*updateScreen)())
+    // Save states
+    bool createSaveState = false;
+    bool loadSaveState = false;
+    std::filesystem::path saveStatePath = "";
+
+    // Emulation thread. Every function that touches the emulator takes the lock, which the thread holds while running each
+    // chunk. It's recursive so that the frame ready callback may call back into the library.
+    std::recursive_mutex lock;
+    std::thread emulationThread;
+    std::atomic<bool> emulationRunning = false;
+    AudioRingBuffer audioRing = AudioRingBuffer(2 * AUDIO_RING_CAPACITY);
+
+    // Display pacing. Fractions of a machine cycle or sample left over from one refresh interval are carried to the next.
+    std::atomic<double> displayRefreshRate = 0.0;
+    double pendingCycles = 0.0;
+    double pendingSamples = 0.0;
+};
+
+GBC_Instance* GBC_Create()
 {
-    frameUpdateCallback = updateScreen;
-    gb->Initialize(frameBuffer);
+    return new GBC_Instance();
 }
 
-bool InsertCartridge(char* romPath, char* saveDirectory, char* romName)
+void GBC_Destroy(GBC_Instance* gbc)
 {
-    return gb->InsertCartridge(romPath, saveDirectory, romName);
+    StopEmulation(gbc);
+    delete gbc;
 }
 
-void PowerOn(char* bootRomPath)
+void Initialize(GBC_Instance* gbc, uint8_t* frameBuffer, void(*updateScreen)(void*), void* userData)
 {
-    gb->PowerOn(bootRomPath);
+    std::lock_guard lock(gbc->lock);
+    gbc->frameUpdateCallback = updateScreen;
+    gbc->callbackUserData = userData;
+    gbc->ownsFrames = (frameBuffer == nullptr);
+
+    if (gbc->ownsFrames)
+    {
+        gbc->gb->Initialize(&gbc->frames);
+    }
+    else
+    {
+        gbc->gb->Initialize(frameBuffer);
+    }
+}
+
+bool InsertCartridge(GBC_Instance* gbc, char* romPath, char* saveDirectory, char* romName)
+{
+    std::lock_guard lock(gbc->lock);
+    return gbc->gb->InsertCartridge(romPath, saveDirectory, romName);
 }
 
-void PowerOff()
+void PowerOn(GBC_Instance* gbc, char* bootRomPath)
 {
-    gb.reset();
+    std::lock_guard lock(gbc->lock);
+    gbc->cycleCount = 0;
+    gbc->gb->PowerOn(bootRomPath);
 }
 
-void CollectAudioSamples(float* buffer, int numSamples)
+void PowerOff(GBC_Instance* gbc)
 {
-    int mCycles = ((numSamples / 2) * SAMPLE_PERIOD) / CPU_CLOCK_PERIOD;
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->PowerOff();
+}
 
+/// @brief Create or load any save state that has been requested, if the Game Boy is at a point where it can be serialized. Right
+///        after power on nothing has run that a save state wouldn't overwrite, so one can also be loaded then.
+static void HandleSaveStateRequests(GBC_Instance* gbc)
+{
+    if (gbc->createSaveState && gbc->gb->IsSerializable())
+    {
+        std::ofstream out(gbc->saveStatePath, std::ios::binary);
+        gbc->createSaveState = false;
+
+        if (!out.fail())
+        {
+            gbc->gb->Serialize(out);
+        }
+    }
+    else if (gbc->loadSaveState && (gbc->gb->IsSerializable() || (gbc->cycleCount == 0)))
+    {
+        std::ifstream in(gbc->saveStatePath, std::ios::binary);
+        gbc->loadSaveState = false;
+
+        if (!in.fail())
+        {
+            gbc->gb->Deserialize(in);
+        }
+    }
+}
+
+/// @brief Present a finished frame, unless it was skipped, and handle any save state requested since the last one.
+static void PresentFrame(GBC_Instance* gbc)
+{
+    if (gbc->frameUpdateCallback && gbc->gb->FrameRendered())
+    {
+        gbc->frameUpdateCallback(gbc->callbackUserData);
+    }
+
+    HandleSaveStateRequests(gbc);
+}
+
+/// @brief Run the Game Boy for a number of machine cycles, presenting any frames finished along the way.
+static void RunForCycles(GBC_Instance* gbc, int mCycles)
+{
     while (mCycles > 0)
     {
-        auto [cyclesRun, refreshScreen] = gb->Clock(mCycles);
+        auto [cyclesRun, refreshScreen] = gbc->gb->Clock(mCycles);
         mCycles -= cyclesRun;
+        gbc->cycleCount += cyclesRun;
 
-        if (refreshScreen && frameUpdateCallback)
+        if (refreshScreen)
         {
-            frameUpdateCallback();
+            PresentFrame(gbc);
+        }
+    }
+}
 
-            if (createSaveState && gb->IsSerializable())
-            {
-                std::ofstream out(saveStatePathFS, std::ios::binary);
-                createSaveState = false;
+/// @brief Run the Game Boy for as long as it takes to produce a number of audio samples, then collect them.
+static void RunForSamples(GBC_Instance* gbc, float* buffer, int numSamples)
+{
+    RunForCycles(gbc, ((numSamples / 2) * gbc->samplePeriod) / gbc->cpuClockPeriod);
+    gbc->gb->DrainSampleBuffer(buffer, numSamples);
+}
 
-                if (!out.fail())
-                {
-                    gb->Serialize(out);
-                }
-            }
-            else if (loadSaveState && gb->IsSerializable())
+void CollectAudioSamples(GBC_Instance* gbc, float* buffer, int numSamples)
+{
+    std::lock_guard lock(gbc->lock);
+    RunForSamples(gbc, buffer, numSamples);
+}
+
+/// @brief Run one display refresh interval's worth of emulation and queue its audio. The resampling ratio is nudged by a tiny
+///        amount so that the audio ring buffer drifts back towards its target fill, making up for the display and audio
+///        device clocks not quite agreeing.
+static void RunRefreshInterval(GBC_Instance* gbc, std::vector<float>& buffer, double const refreshRate)
+{
+    double fill = gbc->audioRing.Size() / 2;
+    int numSamples = 0;
+
+    {
+        std::lock_guard lock(gbc->lock);
+        double const targetFill = gbc->sampleRate * AUDIO_TARGET_LATENCY;
+
+        // Ran dry, e.g. just after starting. Queue silence up to the target rather than taking seconds to creep back up to it.
+        if (fill == 0)
+        {
+            size_t const silence = 2 * static_cast<size_t>(targetFill);
+            buffer.assign(std::max(buffer.size(), silence), 0.0);
+            fill = gbc->audioRing.Write(buffer.data(), silence) / 2;
+        }
+
+        double const frameRate = static_cast<double>(CPU_CLOCK_FREQUENCY) / GBC_M_CYCLES_PER_FRAME;
+        double const speed = static_cast<double>(gbc->emulatedCpuFrequency) / CPU_CLOCK_FREQUENCY;
+        bool const frameLocked = std::abs((refreshRate / frameRate) - 1.0) <= MAX_VSYNC_SKEW;
+        gbc->pendingCycles += frameLocked ? (GBC_M_CYCLES_PER_FRAME * speed) : (gbc->emulatedCpuFrequency / refreshRate);
+
+        double const adjustment = std::clamp((targetFill - fill) / targetFill, -1.0, 1.0) * MAX_RATE_ADJUSTMENT;
+        gbc->pendingSamples += (gbc->sampleRate / refreshRate) * (1.0 + adjustment);
+
+        int const mCycles = gbc->pendingCycles;
+        numSamples = gbc->pendingSamples;
+        gbc->pendingCycles -= mCycles;
+        gbc->pendingSamples -= numSamples;
+
+        if (buffer.size() < static_cast<size_t>(2 * numSamples))
+        {
+            buffer.resize(2 * numSamples);
+        }
+
+        RunForCycles(gbc, mCycles);
+        gbc->gb->DrainSampleBuffer(buffer.data(), 2 * numSamples);
+    }
+
+    gbc->audioRing.Write(buffer.data(), 2 * numSamples);
+}
+
+/// @brief Body of the emulation thread. Without a display refresh rate, keeps the audio ring buffer filled to its target,
+///        sleeping whenever it's full enough. With one, runs an interval of emulation per refresh.
+static void EmulationLoop(GBC_Instance* gbc)
+{
+    std::vector<float> buffer(2 * AUDIO_CHUNK_SIZE);
+    auto nextRefresh = std::chrono::steady_clock::now();
+
+    while (gbc->emulationRunning)
+    {
+        double const refreshRate = gbc->displayRefreshRate;
+
+        if (refreshRate > 0.0)
+        {
+            auto const interval =
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+            auto const now = std::chrono::steady_clock::now();
+
+            // After a slow interval or a pause, start over from now rather than running a burst of intervals to catch up.
+            if ((now - nextRefresh) > (MAX_VSYNC_LAG * interval))
             {
-                std::ifstream in(saveStatePathFS, std::ios::binary);
-                loadSaveState = false;
+                nextRefresh = now;
+            }
+
+            std::this_thread::sleep_until(nextRefresh);
+            nextRefresh += interval;
+            RunRefreshInterval(gbc, buffer, refreshRate);
+            continue;
+        }
+
+        nextRefresh = std::chrono::steady_clock::now();
+
+        if ((gbc->audioRing.Size() + (2 * AUDIO_CHUNK_SIZE)) > (2 * AUDIO_TARGET_FILL))
+        {
+            std::this_thread::sleep_for(EMULATION_THREAD_SLEEP);
+            continue;
+        }
+
+        {
+            std::lock_guard lock(gbc->lock);
+            RunForSamples(gbc, buffer.data(), 2 * AUDIO_CHUNK_SIZE);
+        }
+
+        gbc->audioRing.Write(buffer.data(), 2 * AUDIO_CHUNK_SIZE);
+    }
+}
 
-                if (!in.fail())
-                {
-                    gb->Deserialize(in);
-                }
+/// @brief Check whether the caller is running on the emulation thread, i.e. from the frame ready callback.
+static bool OnEmulationThread(GBC_Instance* gbc)
+{
+    return std::this_thread::get_id() == gbc->emulationThread.get_id();
+}
+
+void StartEmulation(GBC_Instance* gbc)
+{
+    if (gbc->emulationRunning)
+    {
+        return;
+    }
+
+    // Stopped and restarted from the frame ready callback. The thread hasn't exited yet, so just keep it going.
+    if (OnEmulationThread(gbc))
+    {
+        gbc->emulationRunning = true;
+        return;
+    }
+
+    // The thread may have been stopped from the frame ready callback, in which case nothing has joined it yet.
+    if (gbc->emulationThread.joinable())
+    {
+        gbc->emulationThread.join();
+    }
+
+    gbc->emulationRunning = true;
+    gbc->emulationThread = std::thread(EmulationLoop, gbc);
+}
+
+void StopEmulation(GBC_Instance* gbc)
+{
+    gbc->emulationRunning = false;
+
+    // A thread can't join itself. When stopped from the frame ready callback, the thread exits once the callback returns and
+    // is joined by the next call to StartEmulation, StopEmulation, or GBC_Destroy from another thread.
+    if (OnEmulationThread(gbc))
+    {
+        return;
+    }
+
+    if (gbc->emulationThread.joinable())
+    {
+        gbc->emulationThread.join();
+    }
+}
+
+void SetDisplayRefreshRate(GBC_Instance* gbc, double refreshRate)
+{
+    gbc->displayRefreshRate = std::max(refreshRate, 0.0);
+}
+
+uint8_t const* AcquireFrame(GBC_Instance* gbc)
+{
+    return gbc->ownsFrames ? gbc->frames.Acquire() : nullptr;
+}
+
+void ReleaseFrame(GBC_Instance* gbc)
+{
+    if (gbc->ownsFrames)
+    {
+        gbc->frames.Release();
+    }
+}
+
+int ReadAudio(GBC_Instance* gbc, float* buffer, int numSamples)
+{
+    int const numRead = gbc->audioRing.Read(buffer, std::max(numSamples, 0));
+    std::fill(buffer + numRead, buffer + std::max(numSamples, numRead), 0.0);
+    return numRead;
+}
+
+int RunFrames(GBC_Instance* gbc, int numFrames)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetSampleDecimation(0);
+    gbc->gb->DiscardSamples();
+    int framesRun = 0;
+    int cyclesSinceFrame = 0;
+
+    while (framesRun < numFrames)
+    {
+        auto [cyclesRun, refreshScreen] = gbc->gb->Clock(GBC_MAX_M_CYCLES_PER_FRAME - cyclesSinceFrame);
+        cyclesSinceFrame += cyclesRun;
+        gbc->cycleCount += cyclesRun;
+
+        if (refreshScreen || (cyclesSinceFrame == GBC_MAX_M_CYCLES_PER_FRAME))
+        {
+            ++framesRun;
+            cyclesSinceFrame = 0;
+
+            if (refreshScreen)
+            {
+                PresentFrame(gbc);
             }
         }
     }
 
-    gb->DrainSampleBuffer(buffer, numSamples);
+    gbc->gb->SetSampleDecimation(gbc->sampleDecimation);
+    return framesRun;
 }
 
-void SetInputs(bool const down,
+int RunUntil(GBC_Instance* gbc, uint64_t cycle)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetSampleDecimation(0);
+    gbc->gb->DiscardSamples();
+    int framesRun = 0;
+
+    while (gbc->cycleCount < cycle)
+    {
+        auto [cyclesRun, refreshScreen] = gbc->gb->Clock(std::min<uint64_t>(cycle - gbc->cycleCount, GBC_MAX_M_CYCLES_PER_FRAME));
+        gbc->cycleCount += cyclesRun;
+
+        if (refreshScreen)
+        {
+            ++framesRun;
+            PresentFrame(gbc);
+        }
+    }
+
+    gbc->gb->SetSampleDecimation(gbc->sampleDecimation);
+    return framesRun;
+}
+
+uint64_t GetCycleCount(GBC_Instance* gbc)
+{
+    std::lock_guard lock(gbc->lock);
+    return gbc->cycleCount;
+}
+
+void SetAudioDecimation(GBC_Instance* gbc, int factor)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->sampleDecimation = std::max(factor, 1);
+    gbc->gb->SetSampleDecimation(gbc->sampleDecimation);
+}
+
+void SetInputs(GBC_Instance* gbc,
+               bool const down,
                bool const up,
                bool const left,
                bool const right,
@@ -90,60 +425,142 @@ void SetInputs(bool const down,
                bool const b,
                bool const a)
 {
-    gb->SetButtons(down, up, left, right, start, select, b, a);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetButtons(down, up, left, right, start, select, b, a);
+}
+
+void SetClockMultiplier(GBC_Instance* gbc, float const multiplier)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->emulatedCpuFrequency = CPU_CLOCK_FREQUENCY * multiplier;
+    gbc->cpuClockPeriod = 1.0 / gbc->emulatedCpuFrequency;
+}
+
+void CreateSaveState(GBC_Instance* gbc, char* saveStatePath)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->createSaveState = true;
+    gbc->saveStatePath = saveStatePath;
+    HandleSaveStateRequests(gbc);
+}
+
+void LoadSaveState(GBC_Instance* gbc, char* saveStatePath)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->loadSaveState = true;
+    gbc->saveStatePath = saveStatePath;
+    HandleSaveStateRequests(gbc);
+}
+
+void EnableSoundChannel(GBC_Instance* gbc, int const channel, bool const enabled)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->EnableSoundChannel(channel, enabled);
 }
 
-void SetClockMultiplier(float const multiplier)
+void SetMonoAudio(GBC_Instance* gbc, bool const monoAudio)
 {
-    EMULATED_CPU_FREQUENCY = CPU_CLOCK_FREQUENCY * multiplier;
-    CPU_CLOCK_PERIOD = 1.0 / EMULATED_CPU_FREQUENCY;
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetMonoAudio(monoAudio);
 }
 
-void CreateSaveState(char* saveStatePath)
+void SetVolume(GBC_Instance* gbc, float const volume)
 {
-    createSaveState = true;
-    saveStatePathFS = saveStatePath;
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetVolume(volume);
 }
 
-void LoadSaveState(char* saveStatePath)
+void SetSampleRate(GBC_Instance* gbc, int const sampleRate)
 {
-    loadSaveState = true;
-    saveStatePathFS = saveStatePath;
+    if (sampleRate <= 0)
+    {
+        return;
+    }
+
+    std::lock_guard lock(gbc->lock);
+    gbc->sampleRate = sampleRate;
+    gbc->samplePeriod = 1.0 / gbc->sampleRate;
+    gbc->gb->SetSampleRate(sampleRate);
+}
+
+void SetPixelFormat(GBC_Instance* gbc, GBC_PixelFormat format)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetPixelFormat(static_cast<PixelFormat>(format));
+}
+
+void GetPaletteTable(GBC_Instance* gbc, uint16_t* table)
+{
+    std::lock_guard lock(gbc->lock);
+    auto const palette = gbc->gb->PaletteTable();
+    std::copy(palette.begin(), palette.end(), table);
+}
+
+void PreferDmgColors(GBC_Instance* gbc, bool useDmgColors)
+{
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->PreferDmgColors(useDmgColors);
 }
 
-void EnableSoundChannel(int const channel, bool const enabled)
+void UseIndividualPalettes(GBC_Instance* gbc, bool individualPalettes)
 {
-    gb->EnableSoundChannel(channel, enabled);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->UseIndividualPalettes(individualPalettes);
 }
 
-void SetMonoAudio(bool const monoAudio)
+void SetCustomPalette(GBC_Instance* gbc, uint8_t index, uint8_t* data)
 {
-    gb->SetMonoAudio(monoAudio);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetCustomPalette(index, data);
 }
 
-void SetVolume(float const volume)
+void SetInstructionStepping(GBC_Instance* gbc, bool enabled)
 {
-    gb->SetVolume(volume);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetInstructionStepping(enabled);
 }
 
-void SetSampleRate(int const sampleRate)
+void SetScanlineRenderer(GBC_Instance* gbc, bool enabled)
 {
-    SAMPLE_RATE = sampleRate;
-    SAMPLE_PERIOD = 1.0 / SAMPLE_RATE;
-    gb->SetSampleRate(sampleRate);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetScanlineRenderer(enabled);
 }
 
-void PreferDmgColors(bool useDmgColors)
+void SetFrameSkip(GBC_Instance* gbc, int framesToSkip)
 {
-    gb->PreferDmgColors(useDmgColors);
+    std::lock_guard lock(gbc->lock);
+    gbc->gb->SetFrameSkip(std::clamp(framesToSkip, 0, 0xFF));
 }
 
-void UseIndividualPalettes(bool individualPalettes)
+uint64_t HashFrameBuffer(uint8_t const* frameBuffer, int size)
 {
-    gb->UseIndividualPalettes(individualPalettes);
+    return HashFrame(frameBuffer, std::max(size, 0));
 }
 
-void SetCustomPalette(uint8_t index, uint8_t* data)
+void RunBatch(GBC_BatchJob const* jobs, GBC_BatchResult* results, int numJobs, int numThreads)
 {
-    gb->SetCustomPalette(index, data);
+    if (numJobs <= 0)
+    {
+        return;
+    }
+
+    auto path = [](char const* str) { return str ? std::filesystem::path(str) : std::filesystem::path(); };
+    std::vector<BatchJob> batch;
+    batch.reserve(numJobs);
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        batch.push_back({path(jobs[i].romPath),
+                         path(jobs[i].saveStatePath),
+                         path(jobs[i].inputScriptPath),
+                         path(jobs[i].ramDumpPath),
+                         jobs[i].frames});
+    }
+
+    auto batchResults = ::RunBatch(batch, (numThreads > 0) ? numThreads : 0);
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        results[i] = {batchResults[i].success, batchResults[i].framesRun, batchResults[i].cyclesRun, batchResults[i].frameHash};
+    }
 }
@@ -4,6 +4,7 @@
 #include <Cartridge/MBC1.hpp>
 #include <Cartridge/MBC3.hpp>
 #include <Cartridge/MBC5.hpp>
+#include <Cartridge/RomImage.hpp>
 #include <algorithm>
 #include <array>
 #include <cstdint>
@@ -16,19 +17,22 @@
 #include <string>
 #include <utility>
 
+static constexpr size_t CARTRIDGE_HEADER_END = 0x0150;
+
 static constexpr std::array<uint8_t, 16> expectedBootRomBytes = {
     0x31, 0xFE, 0xFF, 0x3E, 0x02, 0xC3, 0x7C, 0x00, 0xD3, 0x00, 0x98, 0xA0, 0x12, 0xD3, 0x00, 0x80
 };
 
 GameBoy::GameBoy() :
     runningBootRom_(false),
-    cpu_(std::bind(&GameBoy::Read, this, std::placeholders::_1),
-         std::bind(&GameBoy::Write, this, std::placeholders::_1, std::placeholders::_2),
-         std::bind(&GameBoy::AcknowledgeInterrupt, this),
-         std::bind(&GameBoy::Stop, this, std::placeholders::_1)),
+    instructionStepping_(true),
+    cpuCyclesAhead_(0),
+    cpu_(*this),
     ppu_(cgbMode_),
     cartridge_(nullptr)
 {
+    readPages_.fill(nullptr);
+    writePages_.fill(nullptr);
 }
 
 void GameBoy::Initialize(uint8_t* frameBuffer)
@@ -37,11 +41,17 @@ void GameBoy::Initialize(uint8_t* frameBuffer)
     ppu_.SetFrameBuffer(frameBuffer);
 }
 
+void GameBoy::Initialize(FrameBuffers* frames)
+{
+    frameBuffer_ = frames->BackBuffer();
+    ppu_.SetFrameBuffers(frames);
+}
+
 bool GameBoy::InsertCartridge(std::filesystem::path const romPath, std::filesystem::path const saveDirectory, char* romName)
 {
-    std::ifstream rom(romPath, std::ios::binary);
+    auto rom = RomImage::Open(romPath);
 
-    if (rom.fail())
+    if (!rom || (rom->Size() < CARTRIDGE_HEADER_END))
     {
         return false;
     }
@@ -52,8 +62,7 @@ bool GameBoy::InsertCartridge(std::filesystem::path const romPath, std::filesyst
     }
 
     bool success = true;
-    std::array<uint8_t, 0x4000> bank0;
-    rom.read(reinterpret_cast<char*>(bank0.data()), sizeof(bank0[0]) * bank0.size());
+    uint8_t const* bank0 = rom->Data();
     uint_fast8_t cartridgeType = bank0[0x0147];
     cgbCartridge_ = (bank0[0x143] & 0x80) == 0x80;
 
@@ -109,16 +118,16 @@ bool GameBoy::InsertCartridge(std::filesystem::path const romPath, std::filesyst
         case 0x00:
         case 0x08:
         case 0x09:
-            cartridge_ = std::make_unique<MBC0>(bank0, rom, savePath, cartridgeType, ramBanks);
+            cartridge_ = std::make_unique<MBC0>(rom, savePath, cartridgeType, ramBanks);
             break;
         case 0x01 ... 0x03:
-            cartridge_ = std::make_unique<MBC1>(bank0, rom, savePath, cartridgeType, romBanks, ramBanks);
+            cartridge_ = std::make_unique<MBC1>(rom, savePath, cartridgeType, romBanks, ramBanks);
             break;
         case 0x0F ... 0x13:
-            cartridge_ = std::make_unique<MBC3>(bank0, rom, savePath, cartridgeType, romBanks, ramBanks);
+            cartridge_ = std::make_unique<MBC3>(rom, savePath, cartridgeType, romBanks, ramBanks);
             break;
         case 0x19 ... 0x1E:
-            cartridge_ = std::make_unique<MBC5>(bank0, rom, savePath, cartridgeType, romBanks, ramBanks);
+            cartridge_ = std::make_unique<MBC5>(rom, savePath, cartridgeType, romBanks, ramBanks);
             break;
         default:
             cartridge_ = nullptr;
@@ -126,9 +135,16 @@ bool GameBoy::InsertCartridge(std::filesystem::path const romPath, std::filesyst
             break;
     }
 
+    MapCartridgePages();
     return success;
 }
 
+void GameBoy::PowerOff()
+{
+    cartridge_.reset();
+    MapCartridgePages();
+}
+
 void GameBoy::PowerOn(std::filesystem::path const bootRomPath)
 {
     if (cartridge_)
@@ -179,6 +195,8 @@ void GameBoy::PowerOn(std::filesystem::path const bootRomPath)
     }
 
     HRAM_.fill(0x00);
+    buttons_ = {};
+    IE_ = 0x00;
 
     if (runningBootRom_)
     {
@@ -195,7 +213,6 @@ void GameBoy::PowerOn(std::filesystem::path const bootRomPath)
 
     serialOutData_ = 0x00;
     serialBitsSent_ = 0;
-    serialTransferCounter_ = 0;
     serialClockDivider_ = 128;
     serialTransferInProgress_ = false;
 
@@ -203,6 +220,8 @@ void GameBoy::PowerOn(std::filesystem::path const bootRomPath)
     timerControl_ = 0;
     timerEnabled_ = false;
     timerReload_ = false;
+    timerSyncedClock_ = 0;
+    dividerSyncedClock_ = 0;
 
     oamDmaInProgress_ = false;
     oamDmaCyclesRemaining_ = 0;
@@ -217,9 +236,19 @@ void GameBoy::PowerOn(std::filesystem::path const bootRomPath)
     lastPendingInterrupt_ = 0x00;
     prevStatState_ = false;
 
+    scheduler_.Reset();
+    masterClock_ = 0;
+    ppuAwake_ = true;
+    ppuIdleStart_ = 0;
+    variableSpeedClocks_ = 0;
+
     apu_.PowerOn(!runningBootRom_);
     cpu_.PowerOn(!runningBootRom_);
     ppu_.PowerOn(!runningBootRom_);
+
+    MapCartridgePages();
+    MapWramPages();
+    ScheduleFrameSequencer();
 }
 
 bool GameBoy::IsSerializable() const
@@ -236,6 +265,8 @@ bool GameBoy::IsSerializable() const
 
 void GameBoy::Serialize(std::ofstream& out)
 {
+    SyncTimer();
+    SyncDivider();
     out.write(reinterpret_cast<char*>(&buttons_), sizeof(buttons_));
 
     for (auto& bank : WRAM_)
@@ -261,6 +292,7 @@ void GameBoy::Serialize(std::ofstream& out)
     cartridge_->Serialize(out);
     apu_.Serialize(out);
     cpu_.Serialize(out);
+    SyncPPU();
     ppu_.Serialize(out);
 }
 
@@ -292,6 +324,28 @@ void GameBoy::Deserialize(std::ifstream& in)
     apu_.Deserialize(in);
     cpu_.Deserialize(in);
     ppu_.Deserialize(in);
+
+    MapCartridgePages();
+    MapWramPages();
+
+    // Nothing that schedules events can be in progress when serializing, other than the PPU being idle and the timer and DIV,
+    // which are restarted from their restored state.
+    scheduler_.Reset();
+    ppuAwake_ = true;
+    timerSyncedClock_ = variableSpeedClocks_;
+    dividerSyncedClock_ = variableSpeedClocks_;
+    ScheduleTimerReload();
+    ScheduleFrameSequencer();
+}
+
+void GameBoy::DumpRam(std::ofstream& out)
+{
+    for (auto& bank : WRAM_)
+    {
+        out.write(reinterpret_cast<char*>(bank.data()), bank.size());
+    }
+
+    out.write(reinterpret_cast<char*>(HRAM_.data()), HRAM_.size());
 }
 
 void GameBoy::UpdateJOYP(uint8_t data)
@@ -500,7 +554,7 @@ std::pair<bool, bool> GameBoy::Stop(bool const IME)
             {
                 SwitchSpeedMode();
                 ioReg_[IO::KEY1] &= 0xFE;
-                apu_.ResetDIV(DoubleSpeedMode());
+                ResetDivider();
                 twoByteOpcode = false;
                 enterHaltMode = false;
             }
@@ -508,17 +562,18 @@ std::pair<bool, bool> GameBoy::Stop(bool const IME)
         else
         {
             // Good path for speed switch.
-            apu_.ResetDIV(DoubleSpeedMode());
+            ResetDivider();
             SwitchSpeedMode();
             ioReg_[IO::KEY1] &= 0xFE;
             speedSwitchCountdown_ = 2050;
+            scheduler_.Cancel(Event::FRAME_SEQUENCER);  // DIV is paused until the switch completes
             twoByteOpcode = true;
             enterHaltMode = true;
         }
     }
     else
     {
-        apu_.ResetDIV(DoubleSpeedMode());
+        ResetDivider();
         twoByteOpcode = !interruptPending;
         enterHaltMode = false;
         stopped_ = true;
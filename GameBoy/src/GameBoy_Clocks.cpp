@@ -1,6 +1,7 @@
 #include <GameBoy.hpp>
 #include <cstdint>
 #include <iostream>
+#include <optional>
 
 std::pair<int, bool> GameBoy::Clock(int const numCycles)
 {
@@ -14,73 +15,164 @@ std::pair<int, bool> GameBoy::Clock(int const numCycles)
 
 std::pair<int, bool> GameBoy::RunMCycles(int const numCycles)
 {
-    for (int i = 0; i < numCycles; ++i)
+    int cyclesRun = 0;
+
+    while (cyclesRun < numCycles)
     {
-        for (uint_fast8_t i = 0; i < 4; ++i)
+        if (cpu_.Halted() && !ppuAwake_)
         {
-            switch (i)
+            int const cyclesSkipped = FastForwardHalt(numCycles - cyclesRun);
+
+            if (cyclesSkipped > 0)
             {
-                case 0:
-                {
-                    if (cpu_.InBetweenInstructions() && (gdmaInProgress_ || (hdmaInProgress_ && vramDmaBytesRemaining_)))
-                    {
-                        transferActive_ = true;
-                        ClockVramDma();
-                    }
-
-                    ClockVariableSpeedComponents(!transferActive_);
-
-                    apu_.Clock();
-                    ppu_.Clock();
-                    break;
-                }
-                case 1:
-                    ppu_.Clock();
-                    break;
-                case 2:
-                    if (DoubleSpeedMode())
-                    {
-                        ClockVariableSpeedComponents(!transferActive_);
-                    }
-
-                    ppu_.Clock();
-                    break;
-                case 3:
-                {
-                    ppu_.Clock();
-                    break;
-                }
+                // The PPU stays asleep throughout, so it can't have finished a frame.
+                cyclesRun += cyclesSkipped;
+                continue;
             }
         }
 
-        bool isMode0 = (ppu_.GetMode() == 0);
-
-        if (hdmaInProgress_ && (!wasMode0_ && isMode0))
+        if (instructionStepping_ && ((numCycles - cyclesRun) >= MAX_INSTRUCTION_M_CYCLES) && CanStepInstruction())
         {
-            vramDmaBytesRemaining_ = 0x10;
+            cyclesRun += StepInstruction();
         }
-
-        wasMode0_ = isMode0;
-
-        if (speedSwitchCountdown_ > 0)
+        else
         {
-            --speedSwitchCountdown_;
-
-            if (speedSwitchCountdown_ == 0)
-            {
-                cpu_.ExitHalt();
-            }
+            ClockMCycle(false);
+            ++cyclesRun;
         }
 
         if (ppu_.FrameReady())
         {
-            return {i + 1, true};
+            return {cyclesRun, true};
         }
     }
 
     return {numCycles, false};
 }
 
+void GameBoy::ClockMCycle(bool const cpuAlreadyClocked)
+{
+    // Dot 0
+    if (!cpuAlreadyClocked &&
+        cpu_.InBetweenInstructions() &&
+        (gdmaInProgress_ || (hdmaInProgress_ && vramDmaBytesRemaining_)))
+    {
+        transferActive_ = true;
+        ClockVramDma();
+    }
+
+    ClockVariableSpeedComponents(!cpuAlreadyClocked && !transferActive_);
+    apu_.Clock();
+    ClockPPU();
+
+    // Dot 1
+    ClockPPU();
+
+    // Dot 2
+    if (DoubleSpeedMode())
+    {
+        ClockVariableSpeedComponents(!transferActive_);
+    }
+
+    ClockPPU();
+
+    // Dot 3
+    ClockPPU();
+
+    bool isMode0 = (ppu_.GetMode() == 0);
+
+    if (hdmaInProgress_ && (!wasMode0_ && isMode0))
+    {
+        vramDmaBytesRemaining_ = 0x10;
+    }
+
+    wasMode0_ = isMode0;
+
+    if (speedSwitchCountdown_ > 0)
+    {
+        --speedSwitchCountdown_;
+
+        if (speedSwitchCountdown_ == 0)
+        {
+            cpu_.ExitHalt();
+
+            // DIV resumes counting from the next variable speed clock.
+            dividerSyncedClock_ = variableSpeedClocks_;
+            ScheduleFrameSequencer();
+        }
+    }
+}
+
+bool GameBoy::CanStepInstruction() const
+{
+    return cpu_.InBetweenInstructions() &&
+           !cpu_.Locked() &&
+           !DoubleSpeedMode() &&
+           (speedSwitchCountdown_ == 0) &&
+           !transferActive_ &&
+           !DmaInProgress();
+}
+
+int GameBoy::StepInstruction()
+{
+    int instructionCycles = 1;
+    cpuCyclesAhead_ = 1;
+    cpu_.Clock(CheckPendingInterrupts());
+
+    // Pending interrupts are only sampled between instructions, so the remaining M-cycles don't need them. An illegal opcode
+    // locks up the CPU partway through an instruction, so never run further ahead than the longest instruction.
+    while (!cpu_.InBetweenInstructions() && (instructionCycles < MAX_INSTRUCTION_M_CYCLES))
+    {
+        ++instructionCycles;
+        ++cpuCyclesAhead_;
+        cpu_.Clock(std::nullopt);
+    }
+
+    CatchUpToCpu();
+    ClockMCycle(true);
+    cpuCyclesAhead_ = 0;
+    return instructionCycles;
+}
+
+void GameBoy::CatchUpToCpu()
+{
+    while (cpuCyclesAhead_ > 1)
+    {
+        ClockMCycle(true);
+
+        // Keep VBlank and STAT edge detection in step with the PPU, just as when the CPU is clocked every M-cycle.
+        CheckPendingInterrupts();
+        --cpuCyclesAhead_;
+    }
+}
+
+int GameBoy::FastForwardHalt(int const maxCycles)
+{
+    if (!cpu_.InBetweenInstructions() || DmaInProgress() || transferActive_ || (speedSwitchCountdown_ > 0))
+    {
+        return 0;
+    }
+
+    // The PPU may have changed mode or line just before going to sleep, so raise any interrupt that causes first.
+    if (CheckPendingInterrupts())
+    {
+        return 0;
+    }
+
+    // Stop short of the M-cycle that the next event falls in, so that it's handled by running that M-cycle normally.
+    uint64_t const cyclesUntilEvent = (scheduler_.NextDot() - masterClock_) / 4;
+    int const cyclesToSkip = (cyclesUntilEvent < static_cast<uint64_t>(maxCycles)) ? cyclesUntilEvent : maxCycles;
+
+    for (int i = 0; i < cyclesToSkip; ++i)
+    {
+        apu_.Clock();
+    }
+
+    masterClock_ += 4 * cyclesToSkip;
+    variableSpeedClocks_ += DoubleSpeedMode() ? (2 * cyclesToSkip) : cyclesToSkip;
+    return cyclesToSkip;
+}
+
 void GameBoy::ClockVariableSpeedComponents(bool const clockCpu)
 {
     if (clockCpu)
@@ -88,9 +180,9 @@ void GameBoy::ClockVariableSpeedComponents(bool const clockCpu)
         cpu_.Clock(CheckPendingInterrupts());
     }
 
-    if (serialTransferInProgress_)
+    if (scheduler_.EventDue(masterClock_, Phase::VARIABLE_SPEED))
     {
-        ClockSerialTransfer();
+        RunDueEvents(Phase::VARIABLE_SPEED);
     }
 
     if (oamDmaInProgress_)
@@ -98,41 +190,190 @@ void GameBoy::ClockVariableSpeedComponents(bool const clockCpu)
         ClockOamDma();
     }
 
-    ClockTimer();
+    // The timer and DIV are brought up to date from this count whenever they're accessed or one of their events is due.
+    ++variableSpeedClocks_;
 }
 
-void GameBoy::ClockTimer()
+void GameBoy::ClockPPU()
 {
-    if (speedSwitchCountdown_ == 0)
+    if (scheduler_.EventDue(masterClock_, Phase::PPU))
     {
-        apu_.ClockDIV(DoubleSpeedMode());
+        RunDueEvents(Phase::PPU);
     }
 
-    if (timerEnabled_)
+    if (ppuAwake_)
     {
-        ++timerCounter_;
+        ppu_.Clock();
+        uint16_t const idleDots = ppu_.IdleDots();
 
-        if (timerReload_)
+        if (idleDots > 0)
         {
-            timerReload_ = false;
-            ioReg_[IO::TIMA] = ioReg_[IO::TMA];
-            ioReg_[IO::IF] |= INT_SRC::TIMER;
+            ppuAwake_ = false;
+            ppuIdleStart_ = masterClock_ + 1;
+            scheduler_.Schedule(Event::PPU_WAKE, ppuIdleStart_ + idleDots, Phase::PPU);
         }
-        else if (timerCounter_ == timerControl_)
-        {
-            timerCounter_ = 0;
-            ++ioReg_[IO::TIMA];
+    }
 
-            if (ioReg_[IO::TIMA] == 0x00)
-            {
-                timerReload_ = true;
-            }
+    ++masterClock_;
+}
+
+void GameBoy::SyncPPU()
+{
+    if (!ppuAwake_)
+    {
+        scheduler_.Cancel(Event::PPU_WAKE);
+        WakePPU();
+    }
+}
+
+void GameBoy::WakePPU()
+{
+    ppu_.SkipDots(masterClock_ - ppuIdleStart_);
+    ppuAwake_ = true;
+}
+
+void GameBoy::RunDueEvents(Phase const phase)
+{
+    while (scheduler_.EventDue(masterClock_, phase))
+    {
+        switch (scheduler_.PopDueEvent())
+        {
+            case Event::PPU_WAKE:
+                WakePPU();
+                break;
+            case Event::SERIAL_BIT:
+                ClockSerialTransfer();
+                break;
+            case Event::TIMER_RELOAD:
+                ReloadTimer();
+                break;
+            case Event::FRAME_SEQUENCER:
+                ClockFrameSequencer();
+                break;
+            default:
+                break;
         }
     }
 }
 
+uint64_t GameBoy::VariableSpeedClockDot(uint64_t const clock) const
+{
+    // The variable speed clock after the last completed one runs (or is running) on the current dot.
+    uint64_t const currentClock = variableSpeedClocks_ + 1;
+
+    if (clock <= currentClock)
+    {
+        return masterClock_;
+    }
+
+    // After a speed switch the current dot may not be aligned to the new speed, so find where the following clock lands.
+    uint_fast8_t const dots = VariableSpeedDots();
+    uint64_t const followingDot = ((masterClock_ / dots) + 1) * dots;
+    return followingDot + ((clock - currentClock - 1) * dots);
+}
+
+void GameBoy::ScheduleVariableSpeedEvent(Event const event, uint64_t const clock)
+{
+    variableSpeedEventClock_[static_cast<size_t>(event)] = clock;
+    scheduler_.Schedule(event, VariableSpeedClockDot(clock), Phase::VARIABLE_SPEED);
+}
+
+void GameBoy::SyncTimer()
+{
+    uint64_t const clocks = variableSpeedClocks_ - timerSyncedClock_;
+    timerSyncedClock_ = variableSpeedClocks_;
+
+    if (!timerEnabled_ || (clocks == 0))
+    {
+        return;
+    }
+
+    // TIMA never passes an overflow here since the following reload is always scheduled.
+    uint64_t const count = timerCounter_ + clocks;
+    uint_fast16_t const tima = ioReg_[IO::TIMA] + (count / timerControl_);
+    timerCounter_ = count % timerControl_;
+    ioReg_[IO::TIMA] = tima & 0xFF;
+
+    if (tima == 0x100)
+    {
+        timerReload_ = true;
+    }
+}
+
+void GameBoy::ScheduleTimerReload()
+{
+    if (!timerEnabled_)
+    {
+        scheduler_.Cancel(Event::TIMER_RELOAD);
+        return;
+    }
+
+    uint64_t overflowClock = timerSyncedClock_;
+
+    if (!timerReload_)
+    {
+        overflowClock += (timerControl_ - timerCounter_) + ((0xFF - ioReg_[IO::TIMA]) * timerControl_);
+    }
+
+    ScheduleVariableSpeedEvent(Event::TIMER_RELOAD, overflowClock + 1);
+}
+
+void GameBoy::ReloadTimer()
+{
+    SyncTimer();
+
+    // The reload takes the place of comparing the counter on this clock.
+    ++timerCounter_;
+    ++timerSyncedClock_;
+    timerReload_ = false;
+    ioReg_[IO::TIMA] = ioReg_[IO::TMA];
+    ioReg_[IO::IF] |= INT_SRC::TIMER;
+    ScheduleTimerReload();
+}
+
+void GameBoy::SyncDivider()
+{
+    if (speedSwitchCountdown_ == 0)
+    {
+        apu_.AdvanceDIV(variableSpeedClocks_ - dividerSyncedClock_, DoubleSpeedMode());
+    }
+
+    dividerSyncedClock_ = variableSpeedClocks_;
+}
+
+void GameBoy::ScheduleFrameSequencer()
+{
+    if (speedSwitchCountdown_ > 0)
+    {
+        scheduler_.Cancel(Event::FRAME_SEQUENCER);
+        return;
+    }
+
+    ScheduleVariableSpeedEvent(Event::FRAME_SEQUENCER, dividerSyncedClock_ + apu_.TicksUntilFrameSequencer(DoubleSpeedMode()));
+}
+
+void GameBoy::ClockFrameSequencer()
+{
+    // Include this clock, which is the one that makes DIV's APU bit fall.
+    SyncDivider();
+    apu_.AdvanceDIV(1, DoubleSpeedMode());
+    ++dividerSyncedClock_;
+    ScheduleFrameSequencer();
+}
+
+void GameBoy::ResetDivider()
+{
+    SyncDivider();
+    SyncTimer();
+    apu_.ResetDIV(DoubleSpeedMode());
+    timerCounter_ = 0;
+    ScheduleFrameSequencer();
+    ScheduleTimerReload();
+}
+
 void GameBoy::ClockOamDma()
 {
+    SyncPPU();
     ppu_.Write(oamDmaDestAddr_++, Read(oamDmaSrcAddr_++), true);
     --oamDmaCyclesRemaining_;
 
@@ -172,26 +413,42 @@ void GameBoy::ClockVramDma()
 
 void GameBoy::ClockSerialTransfer()
 {
-    ++serialTransferCounter_;
+    serialOutData_ <<= 1;
+    serialOutData_ |= (ioReg_[IO::SB] & 0x80) >> 7;
+    ioReg_[IO::SB] <<= 1;
+    ioReg_[IO::SB] |= 0x01;
+    ++serialBitsSent_;
 
-    if (serialTransferCounter_ == 128)
+    if (serialBitsSent_ == 8)
     {
-        serialTransferCounter_ = 0;
-        serialOutData_ <<= 1;
-        serialOutData_ |= (ioReg_[IO::SB] & 0x80) >> 7;
-        ioReg_[IO::SB] <<= 1;
-        ioReg_[IO::SB] |= 0x01;
-        ++serialBitsSent_;
+        serialTransferInProgress_ = false;
+        ioReg_[IO::SC] &= 0x7F;
+        ioReg_[IO::IF] |= INT_SRC::SERIAL;
 
-        if (serialBitsSent_ == 8)
-        {
-            serialTransferInProgress_ = false;
-            ioReg_[IO::SC] &= 0x7F;
-            ioReg_[IO::IF] |= INT_SRC::SERIAL;
+        #ifdef PRINT_SERIAL
+            std::cout << (char)serialOutData_;
+        #endif
+    }
+    else
+    {
+        ScheduleVariableSpeedEvent(Event::SERIAL_BIT, variableSpeedClocks_ + 1 + SERIAL_BIT_PERIOD);
+    }
+}
+
+void GameBoy::SwitchSpeedMode()
+{
+    SyncDivider();
+    ioReg_[IO::KEY1] ^= 0x80;
 
-            #ifdef PRINT_SERIAL
-                std::cout << (char)serialOutData_;
-            #endif
+    // Keep the number of variable speed clocks left until these events, but space them out at the new speed.
+    for (Event const event : {Event::SERIAL_BIT, Event::TIMER_RELOAD})
+    {
+        if (scheduler_.Pending(event))
+        {
+            ScheduleVariableSpeedEvent(event, variableSpeedEventClock_[static_cast<size_t>(event)]);
         }
     }
+
+    // The frame sequencer watches a different DIV bit in double speed mode.
+    ScheduleFrameSequencer();
 }
@@ -2,6 +2,13 @@
 
 uint8_t GameBoy::Read(uint16_t addr)
 {
+    uint8_t const* const page = readPages_[addr >> 8];
+
+    if (page)
+    {
+        return page[addr & 0xFF];
+    }
+
     if (addr < 0x8000)  // Cartridge ROM
     {
         if (runningBootRom_)
@@ -25,6 +32,7 @@ uint8_t GameBoy::Read(uint16_t addr)
     }
     else if (addr < 0xA000)  // VRAM
     {
+        SyncPPU();
         return ppu_.Read(addr);
     }
     else if (addr < 0xC000) // Cartridge RAM
@@ -46,6 +54,7 @@ uint8_t GameBoy::Read(uint16_t addr)
     }
     else if (addr < 0xFEA0)  // OAM
     {
+        SyncPPU();
         return ppu_.Read(addr);
     }
     else if (addr < 0xFF00)  // Unusable, prohibited, TODO
@@ -70,12 +79,36 @@ uint8_t GameBoy::Read(uint16_t addr)
 
 void GameBoy::Write(uint16_t addr, uint8_t data)
 {
+    uint8_t* const page = writePages_[addr >> 8];
+
+    if (page)
+    {
+        page[addr & 0xFF] = data;
+        return;
+    }
+
     if (addr < 0x8000)  // Cartridge ROM
     {
-        cartridge_->WriteROM(addr, data);
+        uint8_t const bankChange = cartridge_->WriteROM(addr, data);
+
+        if (bankChange & BankChange::ROM_0)
+        {
+            MapRomPages(0x00, 0x40);
+        }
+
+        if (bankChange & BankChange::ROM_X)
+        {
+            MapRomPages(0x40, 0x80);
+        }
+
+        if (bankChange & BankChange::RAM)
+        {
+            MapRamPages();
+        }
     }
     else if (addr < 0xA000)  // VRAM
     {
+        SyncPPU();
         ppu_.Write(addr, data);
     }
     else if (addr < 0xC000)  // Cartridge RAM
@@ -97,6 +130,7 @@ void GameBoy::Write(uint16_t addr, uint8_t data)
     }
     else if (addr < 0xFEA0)   // OAM
     {
+        SyncPPU();
         ppu_.Write(addr, data);
     }
     else if (addr < 0xFF00)  // Unusable, prohibited, TODO
@@ -117,6 +151,88 @@ void GameBoy::Write(uint16_t addr, uint8_t data)
     }
 }
 
+void GameBoy::MapCartridgePages()
+{
+    MapRomPages(0x00, 0x80);
+    MapRamPages();
+}
+
+void GameBoy::MapRomPages(uint_fast16_t firstPage, uint_fast16_t endPage)
+{
+    for (uint_fast16_t page = firstPage; page < endPage; ++page)
+    {
+        uint16_t const addr = page << 8;
+
+        if (runningBootRom_ && ((addr < 0x0100) || ((addr >= 0x0200) && (addr < 0x0900))))
+        {
+            readPages_[page] = &BOOT_ROM[addr];
+        }
+        else
+        {
+            readPages_[page] = cartridge_ ? (cartridge_->MappedRomBank(addr) + (addr & 0x3FFF)) : nullptr;
+        }
+    }
+}
+
+void GameBoy::MapRamPages()
+{
+    uint8_t const* ramReadBank = cartridge_ ? cartridge_->MappedRamReadBank() : nullptr;
+    uint8_t* ramWriteBank = cartridge_ ? cartridge_->MappedRamWriteBank() : nullptr;
+
+    for (uint_fast16_t page = 0xA0; page < 0xC0; ++page)
+    {
+        uint_fast16_t const offset = (page - 0xA0) << 8;
+        readPages_[page] = ramReadBank ? (ramReadBank + offset) : nullptr;
+        writePages_[page] = ramWriteBank ? (ramWriteBank + offset) : nullptr;
+    }
+}
+
+void GameBoy::MapWramPages()
+{
+    uint8_t ramBank = (!cgbMode_ || (ioReg_[IO::SVBK] == 0x00)) ? 0x01 : (ioReg_[IO::SVBK] & 0x07);
+
+    for (uint_fast16_t page = 0x00; page < 0x10; ++page)
+    {
+        readPages_[0xC0 + page] = &WRAM_[0][page << 8];
+        writePages_[0xC0 + page] = &WRAM_[0][page << 8];
+        readPages_[0xD0 + page] = &WRAM_[ramBank][page << 8];
+        writePages_[0xD0 + page] = &WRAM_[ramBank][page << 8];
+    }
+}
+
+uint8_t GameBoy::CpuRead(uint16_t addr)
+{
+    if ((cpuCyclesAhead_ > 1) && !CpuPrivateAddress(addr))
+    {
+        CatchUpToCpu();
+    }
+
+    return Read(addr);
+}
+
+void GameBoy::CpuWrite(uint16_t addr, uint8_t data)
+{
+    if ((cpuCyclesAhead_ > 1) && !CpuPrivateAddress(addr))
+    {
+        CatchUpToCpu();
+    }
+
+    Write(addr, data);
+}
+
+bool GameBoy::CpuPrivateAddress(uint16_t addr) const
+{
+    if (DmaInProgress())
+    {
+        // DMA sources can be anywhere the CPU can access.
+        return false;
+    }
+
+    return (addr < 0x8000) ||                      // Cartridge ROM
+           ((addr >= 0xA000) && (addr < 0xFE00)) ||  // Cartridge RAM, WRAM, ECHO RAM
+           ((addr >= 0xFF80) && (addr < 0xFFFF));    // HRAM
+}
+
 uint8_t GameBoy::ReadIoReg(uint16_t addr)
 {
     uint_fast8_t ioAddr = addr & 0x00FF;
@@ -130,8 +246,10 @@ uint8_t GameBoy::ReadIoReg(uint16_t addr)
         case IO::SC:  // Serial transfer control
             return ioReg_[IO::SC];
         case IO::DIV:  // Divider register
+            SyncDivider();
             return apu_.GetDIV();
         case IO::TIMA: // Timer counter
+            SyncTimer();
             return ioReg_[IO::TIMA];
         case IO::TMA:  // Timer modulo
             return ioReg_[IO::TMA];
@@ -144,6 +262,7 @@ uint8_t GameBoy::ReadIoReg(uint16_t addr)
         case IO::BGP ... IO::WX:
         case IO::VBK:
         case IO::BCPS ... IO::OPRI:
+            SyncPPU();
             return ppu_.Read(addr);
 
         case IO::NR10 ... IO::WAVE_RAM_END:  // APU
@@ -189,12 +308,13 @@ void GameBoy::WriteIoReg(uint16_t addr, uint8_t data)
             IoWriteSC(data);
             break;
         case IO::DIV:  // Divider register
-            apu_.ResetDIV(DoubleSpeedMode());
-            timerCounter_ = 0;
+            ResetDivider();
             break;
         case IO::TIMA:  // Timer counter
+            SyncTimer();
             timerReload_ = false;
             ioReg_[IO::TIMA] = data;
+            ScheduleTimerReload();
             break;
         case IO::TMA:  // Timer modulo
             ioReg_[IO::TMA] = data;
@@ -210,6 +330,7 @@ void GameBoy::WriteIoReg(uint16_t addr, uint8_t data)
         case IO::BGP ... IO::WX:
         case IO::VBK:
         case IO::BCPS ... IO::OPRI:
+            SyncPPU();
             ppu_.Write(addr, data);
             break;
 
@@ -228,6 +349,9 @@ void GameBoy::WriteIoReg(uint16_t addr, uint8_t data)
             {
                 runningBootRom_ = false;
                 cgbMode_ = cgbCartridge_;
+                ppu_.CgbModeChanged();
+                MapCartridgePages();
+                MapWramPages();
             }
             break;
         case IO::HDMA1 ... IO::HDMA4:  // VRAM  DMA src/dest
@@ -240,6 +364,7 @@ void GameBoy::WriteIoReg(uint16_t addr, uint8_t data)
             break;
         case IO::SVBK:  // WRAM bank
             ioReg_[IO::SVBK] = data;
+            MapWramPages();
             break;
         case IO::ff72 ... IO::ff74:
             ioReg_[ioAddr] = data;
@@ -260,7 +385,12 @@ void GameBoy::IoWriteSC(uint8_t data)
         serialTransferInProgress_ = (data & 0x81) == 0x81;
         serialBitsSent_ = 0;
 
-        serialTransferCounter_ = 0;
+        if (serialTransferInProgress_)
+        {
+            // This variable speed clock counts towards the first bit.
+            ScheduleVariableSpeedEvent(Event::SERIAL_BIT, variableSpeedClocks_ + SERIAL_BIT_PERIOD);
+        }
+
         bool fastClock = data & 0x02;
 
         if (DoubleSpeedMode())
@@ -276,6 +406,7 @@ void GameBoy::IoWriteSC(uint8_t data)
 
 void GameBoy::IoWriteTAC(uint8_t data)
 {
+    SyncTimer();
     ioReg_[IO::TAC] = (data | 0xF8);
     timerCounter_ = 0;
     timerEnabled_ = data & 0x04;
@@ -296,6 +427,8 @@ void GameBoy::IoWriteTAC(uint8_t data)
             timerControl_ = 64;
             break;
     }
+
+    ScheduleTimerReload();
 }
 
 void GameBoy::IoWriteDMA(uint8_t data)
@@ -1,24 +1,31 @@
 #include <PPU.hpp>
+#include <algorithm>
 #include <array>
 #include <cstdint>
-
-typedef std::array<std::array<uint8_t, 3>, 4> PaletteArray;
-
-PaletteArray DMG_PALETTE = {{{175, 203, 70},
-                             {121, 170, 109},
-                             {34, 111, 95},
-                             {8, 41, 85}}};
-
-PaletteArray BG_PALETTE = DMG_PALETTE;
-PaletteArray WIN_PALETTE = DMG_PALETTE;
-PaletteArray OBP0_PALETTE = DMG_PALETTE;
-PaletteArray OBP1_PALETTE = DMG_PALETTE;
+#include <cstring>
 
 PPU::PPU(bool const& cgbMode) :
     preferDmgColors_(false),
     useIndividualPalettes_(false),
+    dmgPalette_(DEFAULT_DMG_PALETTE),
+    bgPalette_(DEFAULT_DMG_PALETTE),
+    winPalette_(DEFAULT_DMG_PALETTE),
+    obp0Palette_(DEFAULT_DMG_PALETTE),
+    obp1Palette_(DEFAULT_DMG_PALETTE),
+    colorCacheDirty_(true),
+    pixelFormat_(PixelFormat::RGB888),
+    bytesPerPixel_(3),
     cgbMode_(cgbMode),
+    frameBuffer_(nullptr),
+    frames_(nullptr),
     frameReady_(false),
+    scanlineRenderer_(false),
+    scanlineDeferred_(false),
+    scanlineWindowVisible_(false),
+    frameSkip_(0),
+    frameSkipCounter_(0),
+    skipFrame_(false),
+    frameRendered_(true),
     pixelFifoPtr_(std::make_unique<PixelFIFO>(this))
 {
 }
@@ -43,6 +50,15 @@ void PPU::PowerOn(bool const skipBootRom)
     disabledY_ = 0;
     firstEnabledFrame_ = false;
 
+    scanlineDeferred_ = false;
+    scanlineWindowVisible_ = false;
+    numLineSprites_ = 0;
+    colorCacheDirty_ = true;
+
+    frameSkipCounter_ = 0;
+    skipFrame_ = false;
+    frameRendered_ = true;
+
     if (skipBootRom)
     {
         LCDC_ = 0x91;
@@ -96,7 +112,7 @@ void PPU::Clock()
         dot_ = 0;
         ++LY_;
 
-        if (pixelFifoPtr_->WindowVisible())
+        if (WindowVisible())
         {
             ++windowY_;
         }
@@ -116,10 +132,15 @@ void PPU::Clock()
         {
             SetMode(1);
             frameReady_ = true;
-            framePointer_ = 0;
+            PublishFrame();
             vBlank_ = true;
             wyCondition_ = false;
-            firstEnabledFrame_ = false;
+
+            if (firstEnabledFrame_)
+            {
+                firstEnabledFrame_ = false;
+                colorCacheDirty_ = true;
+            }
         }
     }
     else if (LY_ < 144)
@@ -136,17 +157,31 @@ void PPU::Clock()
         else if (dot_ == 81)
         {
             SetMode(3);
+
+            // Skipped frames always take the scanline renderer's path, since it works out mode 3's length without the FIFO.
+            if (scanlineRenderer_ || skipFrame_)
+            {
+                BeginScanline();
+            }
         }
-        else if (LX_ == 160)
+        else
         {
-            LX_ = 0;
-            SetMode(0);
+            if (scanlineDeferred_ && (dot_ == mode3EndDot_))
+            {
+                RenderScanline();
+            }
+
+            if (LX_ == 160)
+            {
+                LX_ = 0;
+                SetMode(0);
+            }
         }
     }
 
     SetLYC();
 
-    if ((GetMode() == 3) && (dot_ > 84))
+    if ((GetMode() == 3) && (dot_ > 84) && !scanlineDeferred_)
     {
         auto pixel = pixelFifoPtr_->Clock();
 
@@ -170,19 +205,86 @@ void PPU::DisabledClock()
         if (disabledY_ == 144)
         {
             frameReady_ = true;
-            framePointer_ = 0;
+            PublishFrame();
         }
         else if (disabledY_ == 154)
         {
             disabledY_ = 0;
         }
     }
-    else if ((disabledY_ < 144) && (dot_ < 161))
+    else if (!skipFrame_ && (disabledY_ < 144) && (dot_ < 161))
     {
-        frameBuffer_[framePointer_++] = 0xFF;
-        frameBuffer_[framePointer_++] = 0xFF;
-        frameBuffer_[framePointer_++] = 0xFF;
+        if (colorCacheDirty_)
+        {
+            RebuildColorCache();
+        }
+
+        WritePixel(blankColor_);
+    }
+}
+
+void PPU::PublishFrame()
+{
+    framePointer_ = 0;
+    frameRendered_ = !skipFrame_;
+
+    if (frames_ && frameRendered_)
+    {
+        frameBuffer_ = frames_->Publish();
     }
+
+    frameSkipCounter_ = (frameSkipCounter_ >= frameSkip_) ? 0 : (frameSkipCounter_ + 1);
+    skipFrame_ = (frameSkipCounter_ != 0);
+}
+
+void PPU::SetFrameSkip(uint8_t const framesToSkip)
+{
+    frameSkip_ = framesToSkip;
+    frameSkipCounter_ = std::min(frameSkipCounter_, frameSkip_);
+}
+
+uint16_t PPU::IdleDots() const
+{
+    // Scanlines end when dot_ reaches 457.
+    uint16_t const dotsLeftInLine = 456 - dot_;
+
+    if (!LCDEnabled())
+    {
+        // Blank pixels are only drawn for the first 160 dots of each visible line.
+        return (skipFrame_ || (disabledY_ >= 144) || (dot_ >= 160)) ? dotsLeftInLine : 0;
+    }
+
+    if (LY_ >= 144)
+    {
+        return dotsLeftInLine;
+    }
+
+    if ((LY_ == WY_) && !wyCondition_)
+    {
+        return 0;
+    }
+
+    if ((GetMode() == 3) && scanlineDeferred_)
+    {
+        return (mode3EndDot_ - 1) - dot_;
+    }
+
+    if ((GetMode() == 3) || (LX_ == 160))
+    {
+        return 0;
+    }
+
+    // The OAM scan and switch to mode 3 happen when dot_ reaches 80 and 81, regardless of the current mode.
+    if (dot_ < 79)
+    {
+        return 79 - dot_;
+    }
+    else if (dot_ < 81)
+    {
+        return 0;
+    }
+
+    return dotsLeftInLine;
 }
 
 uint8_t PPU::Read(uint16_t addr) const
@@ -338,147 +440,264 @@ void PPU::Deserialize(std::ifstream& in)
 
     in.read(reinterpret_cast<char*>(&disabledY_), sizeof(disabledY_));
     in.read(reinterpret_cast<char*>(&firstEnabledFrame_), sizeof(firstEnabledFrame_));
+
+    scanlineDeferred_ = false;
+    colorCacheDirty_ = true;
 }
 
 void PPU::OamScan()
 {
-    std::vector<OamEntry> currentSprites;
+    numLineSprites_ = 0;
+    scanlineWindowVisible_ = false;
 
     if (oamDmaInProgress_)
     {
-        pixelFifoPtr_->LoadSprites(currentSprites);
+        pixelFifoPtr_->LoadSprites(lineSprites_, numLineSprites_);
         return;
     }
 
     auto oamPtr = reinterpret_cast<OamEntry const*>(OAM_.data());
-    size_t numSprites = 0;
+    uint_fast16_t const adjustedLY = LY_ + 16;
+    uint_fast8_t const spriteHeight = TallSpriteMode() ? 16 : 8;
 
-    for (uint_fast8_t oamIndex = 0; oamIndex < 40; ++oamIndex)
+    for (uint_fast8_t oamIndex = 0; (oamIndex < 40) && (numLineSprites_ < MAX_SPRITES_PER_LINE); ++oamIndex)
     {
-        if (numSprites == 10)
+        // A sprite is on this line if LY is within spriteHeight lines of its top. Wrapping the difference to unsigned covers
+        // both ends of that range with a single comparison.
+        uint_fast16_t const spriteRow = adjustedLY - oamPtr[oamIndex].yPos;
+
+        if (spriteRow < spriteHeight)
         {
-            break;
+            lineSprites_[numLineSprites_++] = oamPtr[oamIndex];
         }
+    }
+
+    pixelFifoPtr_->LoadSprites(lineSprites_, numLineSprites_);
+}
 
-        uint_fast16_t adjustedLY = LY_ + 16;
-        uint_fast16_t spriteTopLine = oamPtr[oamIndex].yPos;
-        uint_fast16_t spriteBotLine = oamPtr[oamIndex].yPos + (TallSpriteMode() ? 15 : 7);
+void PPU::RenderPixel(Pixel pixel)
+{
+    if (skipFrame_)
+    {
+        return;
+    }
 
-        if ((spriteTopLine <= adjustedLY) && (spriteBotLine >= adjustedLY))
+    if (colorCacheDirty_)
+    {
+        RebuildColorCache();
+    }
+
+    WritePixel(colorCache_[ColorCacheIndex(pixel)]);
+}
+
+void PPU::WritePixel(uint32_t const color)
+{
+    uint8_t* const dest = &frameBuffer_[framePointer_];
+
+    switch (bytesPerPixel_)
+    {
+        case 1:
+            *dest = color;
+            break;
+        case 2:
         {
-            currentSprites.push_back(oamPtr[oamIndex]);
-            ++numSprites;
+            uint16_t const word = color;
+            std::memcpy(dest, &word, sizeof(word));
+            break;
         }
+        default:
+            // Byte formats are stored in the cache in memory order, so RGB888 is the first three bytes of the word.
+            std::memcpy(dest, &color, bytesPerPixel_);
+            break;
     }
 
-    pixelFifoPtr_->LoadSprites(currentSprites);
+    framePointer_ += bytesPerPixel_;
 }
 
-void PPU::RenderPixel(Pixel pixel)
+void PPU::SetPixelFormat(PixelFormat const format)
 {
-    if (!cgbMode_ && (forceDmgColors_ || preferDmgColors_))
+    uint8_t const bytesPerPixel = (format == PixelFormat::INDEXED8) ? 1 :
+                                  ((format == PixelFormat::RGB565) || (format == PixelFormat::RGB555)) ? 2 :
+                                  (format == PixelFormat::RGB888) ? 3 : 4;
+
+    // Keep drawing from the same pixel if switching part way through a frame.
+    framePointer_ = (framePointer_ / bytesPerPixel_) * bytesPerPixel;
+    pixelFormat_ = format;
+    bytesPerPixel_ = bytesPerPixel;
+    colorCacheDirty_ = true;
+}
+
+uint32_t PPU::EncodeColor(std::array<uint8_t, 3> const rgb) const
+{
+    auto [r, g, b] = rgb;
+
+    switch (pixelFormat_)
     {
-        RenderDmgPixel(pixel);
+        case PixelFormat::XRGB8888:
+            return 0xFF000000 | (r << 16) | (g << 8) | b;
+        case PixelFormat::RGB565:
+            return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+        case PixelFormat::RGB555:
+            return (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+        default:
+        {
+            std::array<uint8_t, 4> const bytes = {r, g, b, 0xFF};
+            uint32_t color;
+            std::memcpy(&color, bytes.data(), sizeof(color));
+            return color;
+        }
     }
-    else if (firstEnabledFrame_ || (pixel.src == PixelSource::BLANK))
+}
+
+uint8_t PPU::PixelIndex(Pixel const pixel) const
+{
+    if (firstEnabledFrame_ || (pixel.src == PixelSource::BLANK))
     {
-        frameBuffer_[framePointer_++] = 0xFF;
-        frameBuffer_[framePointer_++] = 0xFF;
-        frameBuffer_[framePointer_++] = 0xFF;
+        return cgbMode_ ? 0xFF : 0;
     }
     else if (cgbMode_)
     {
-        uint_fast8_t colorIndex = (pixel.palette * 8) + (pixel.color * 2);
-        uint_fast8_t lsb = 0x00;
-        uint_fast8_t msb = 0x00;
+        return ((pixel.src == PixelSource::SPRITE) ? 32 : 0) | (pixel.palette << 2) | pixel.color;
+    }
+    else if (pixel.src == PixelSource::SPRITE)
+    {
+        return ((pixel.palette ? OBP1_ : OBP0_) >> (pixel.color * 2)) & 0x03;
+    }
 
-        if ((pixel.src == PixelSource::BACKGROUND) || (pixel.src == PixelSource::WINDOW))
+    return (BGP_ >> (pixel.color * 2)) & 0x03;
+}
+
+std::array<uint16_t, 64> PPU::PaletteTable() const
+{
+    std::array<uint16_t, 64> table = {};
+
+    if (!cgbMode_ && (forceDmgColors_ || preferDmgColors_))
+    {
+        for (uint_fast8_t shade = 0; shade < 4; ++shade)
         {
-            lsb = BG_CRAM_[colorIndex];
-            msb = BG_CRAM_[colorIndex + 1];
+            auto [r, g, b] = dmgPalette_[shade];
+            table[shade] = (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
         }
-        else
+
+        return table;
+    }
+
+    for (uint_fast8_t i = 0; i < 32; ++i)
+    {
+        table[i] = (BG_CRAM_[(i * 2) + 1] << 8) | BG_CRAM_[i * 2];
+        table[i + 32] = (OBJ_CRAM_[(i * 2) + 1] << 8) | OBJ_CRAM_[i * 2];
+    }
+
+    return table;
+}
+
+void PPU::RebuildColorCache()
+{
+    colorCacheDirty_ = false;
+
+    for (uint_fast8_t src = 0; src < 4; ++src)
+    {
+        for (uint_fast8_t palette = 0; palette < 8; ++palette)
         {
-            lsb = OBJ_CRAM_[colorIndex];
-            msb = OBJ_CRAM_[colorIndex + 1];
+            for (uint_fast8_t color = 0; color < 4; ++color)
+            {
+                Pixel const pixel = {color, palette, 0x00, false, static_cast<PixelSource>(src)};
+                colorCache_[ColorCacheIndex(pixel)] =
+                    (pixelFormat_ == PixelFormat::INDEXED8) ? PixelIndex(pixel) : EncodeColor(PixelColor(pixel));
+            }
         }
+    }
 
-        uint_fast16_t rgb555 = (msb << 8) | lsb;
+    Pixel const blank = {0, 0, 0x00, false, PixelSource::BLANK};
+    blankColor_ = (pixelFormat_ == PixelFormat::INDEXED8) ? PixelIndex(blank) : EncodeColor({0xFF, 0xFF, 0xFF});
+}
 
-        uint_fast8_t r = rgb555 & 0x001F;
-        frameBuffer_[framePointer_++] = ((r << 3) | (r >> 2));
+std::array<uint8_t, 3> PPU::PixelColor(Pixel pixel) const
+{
+    if (!cgbMode_ && (forceDmgColors_ || preferDmgColors_))
+    {
+        return DmgPixelColor(pixel);
+    }
+    else if (firstEnabledFrame_ || (pixel.src == PixelSource::BLANK))
+    {
+        return {0xFF, 0xFF, 0xFF};
+    }
 
-        uint_fast8_t g = (rgb555 & 0x03E0) >> 5;
-        frameBuffer_[framePointer_++] = ((g << 3) | (g >> 2));
+    uint_fast8_t lsb = 0x00;
+    uint_fast8_t msb = 0x00;
 
-        uint_fast8_t b = (rgb555 & 0x7C00) >> 10;
-        frameBuffer_[framePointer_++] = ((b << 3) | (b >> 2));
-    }
-    else
+    if (cgbMode_)
     {
-        uint_fast8_t lsb = 0x00;
-        uint_fast8_t msb = 0x00;
+        uint_fast8_t colorIndex = (pixel.palette * 8) + (pixel.color * 2);
 
-        if (pixel.src == PixelSource::BACKGROUND)
+        if ((pixel.src == PixelSource::BACKGROUND) || (pixel.src == PixelSource::WINDOW))
         {
-            uint_fast8_t colorIndex = ((BGP_ >> (pixel.color * 2)) & 0x03) * 2;
             lsb = BG_CRAM_[colorIndex];
             msb = BG_CRAM_[colorIndex + 1];
         }
         else
         {
-            uint_fast8_t palette = pixel.palette ? OBP1_ : OBP0_;
-            uint_fast8_t color = ((palette >> (pixel.color * 2)) & 0x03) * 2;
-            uint_fast8_t colorIndex = color + (pixel.palette ? 8 : 0);
             lsb = OBJ_CRAM_[colorIndex];
             msb = OBJ_CRAM_[colorIndex + 1];
         }
+    }
+    else if (pixel.src == PixelSource::BACKGROUND)
+    {
+        uint_fast8_t colorIndex = ((BGP_ >> (pixel.color * 2)) & 0x03) * 2;
+        lsb = BG_CRAM_[colorIndex];
+        msb = BG_CRAM_[colorIndex + 1];
+    }
+    else
+    {
+        uint_fast8_t palette = pixel.palette ? OBP1_ : OBP0_;
+        uint_fast8_t color = ((palette >> (pixel.color * 2)) & 0x03) * 2;
+        uint_fast8_t colorIndex = color + (pixel.palette ? 8 : 0);
+        lsb = OBJ_CRAM_[colorIndex];
+        msb = OBJ_CRAM_[colorIndex + 1];
+    }
 
-        uint_fast16_t rgb555 = (msb << 8) | lsb;
-
-        uint_fast8_t r = rgb555 & 0x001F;
-        frameBuffer_[framePointer_++] = ((r << 3) | (r >> 2));
-
-        uint_fast8_t g = (rgb555 & 0x03E0) >> 5;
-        frameBuffer_[framePointer_++] = ((g << 3) | (g >> 2));
+    uint_fast16_t rgb555 = (msb << 8) | lsb;
+    uint_fast8_t r = rgb555 & 0x001F;
+    uint_fast8_t g = (rgb555 & 0x03E0) >> 5;
+    uint_fast8_t b = (rgb555 & 0x7C00) >> 10;
 
-        uint_fast8_t b = (rgb555 & 0x7C00) >> 10;
-        frameBuffer_[framePointer_++] = ((b << 3) | (b >> 2));
-    }
+    return {static_cast<uint8_t>((r << 3) | (r >> 2)),
+            static_cast<uint8_t>((g << 3) | (g >> 2)),
+            static_cast<uint8_t>((b << 3) | (b >> 2))};
 }
 
-void PPU::RenderDmgPixel(Pixel pixel)
+std::array<uint8_t, 3> PPU::DmgPixelColor(Pixel pixel) const
 {
     PaletteArray const* palette;
     uint_fast8_t colorIndex;
 
     if (firstEnabledFrame_ || (pixel.src == PixelSource::BLANK))
     {
-        palette = &DMG_PALETTE;
+        palette = &dmgPalette_;
         colorIndex = 0;
     }
     else if (useIndividualPalettes_)
     {
         if (pixel.src == PixelSource::BACKGROUND)
         {
-            palette = &BG_PALETTE;
+            palette = &bgPalette_;
             colorIndex = ((BGP_ >> (pixel.color * 2)) & 0x03);
         }
         else if (pixel.src == PixelSource::WINDOW)
         {
-            palette = &WIN_PALETTE;
+            palette = &winPalette_;
             colorIndex = ((BGP_ >> (pixel.color * 2)) & 0x03);
         }
         else
         {
             uint_fast8_t obp = pixel.palette ? OBP1_ : OBP0_;
-            palette = pixel.palette ? &OBP1_PALETTE : &OBP0_PALETTE;
+            palette = pixel.palette ? &obp1Palette_ : &obp0Palette_;
             colorIndex = ((obp >> (pixel.color * 2)) & 0x03);
         }
     }
     else
     {
-        palette = &DMG_PALETTE;
+        palette = &dmgPalette_;
 
         if ((pixel.src == PixelSource::BACKGROUND) || (pixel.src == PixelSource::WINDOW))
         {
@@ -491,9 +710,7 @@ void PPU::RenderDmgPixel(Pixel pixel)
         }
     }
 
-    frameBuffer_[framePointer_++] = (*palette)[colorIndex][0];
-    frameBuffer_[framePointer_++] = (*palette)[colorIndex][1];
-    frameBuffer_[framePointer_++] = (*palette)[colorIndex][2];
+    return (*palette)[colorIndex];
 }
 
 uint8_t PPU::ReadIoReg(uint8_t ioAddr) const
@@ -562,6 +779,31 @@ uint8_t PPU::ReadIoReg(uint8_t ioAddr) const
 
 void PPU::WriteIoReg(uint8_t ioAddr, uint8_t data)
 {
+    if (scanlineDeferred_)
+    {
+        switch (ioAddr)
+        {
+            case IO::BGP:
+            case IO::OBP0:
+            case IO::OBP1:
+                // Palettes only change colors, which skipped frames don't produce, so they don't need the pixel FIFO.
+                if (!skipFrame_)
+                {
+                    ResumePixelFifo();
+                }
+                break;
+            case IO::LCDC:
+            case IO::SCY:
+            case IO::SCX:
+            case IO::WY:
+            case IO::WX:
+                ResumePixelFifo();
+                break;
+            default:
+                break;
+        }
+    }
+
     switch (ioAddr)
     {
         case IO::LCDC: // LCD control
@@ -589,6 +831,7 @@ void PPU::WriteIoReg(uint8_t ioAddr, uint8_t data)
                 framePointer_ = 0;
                 frameReady_ = false;
                 firstEnabledFrame_ = true;
+                colorCacheDirty_ = true;
                 SetMode(2);
             }
             break;
@@ -613,12 +856,15 @@ void PPU::WriteIoReg(uint8_t ioAddr, uint8_t data)
             break;
         case IO::BGP:  // BG palette data (Non-CGB mode only)
             BGP_ = data;
+            colorCacheDirty_ = true;
             break;
         case IO::OBP0: // OBJ palette 0 data (Non-CGB mode only)
             OBP0_ = data;
+            colorCacheDirty_ = true;
             break;
         case IO::OBP1: // OBJ palette 1 data (Non-CGB mode only)
             OBP1_ = data;
+            colorCacheDirty_ = true;
             break;
         case IO::WY:   // Window y position
             WY_ = data;
@@ -637,6 +883,7 @@ void PPU::WriteIoReg(uint8_t ioAddr, uint8_t data)
             if (GetMode() != 3)
             {
                 BG_CRAM_[BCPS_ & 0x3F] = data;
+                colorCacheDirty_ = true;
             }
 
             if (BCPS_ & 0x80)
@@ -654,6 +901,7 @@ void PPU::WriteIoReg(uint8_t ioAddr, uint8_t data)
             if (GetMode() != 3)
             {
                 OBJ_CRAM_[OCPS_ & 0x3F] = data;
+                colorCacheDirty_ = true;
             }
 
             if (OCPS_ & 0x80)
@@ -678,19 +926,19 @@ void PPU::SetCustomPalette(uint8_t index, uint8_t* data)
     switch (index)
     {
         case 0:
-            palette = &DMG_PALETTE;
+            palette = &dmgPalette_;
             break;
         case 1:
-            palette = &BG_PALETTE;
+            palette = &bgPalette_;
             break;
         case 2:
-            palette = &WIN_PALETTE;
+            palette = &winPalette_;
             break;
         case 3:
-            palette = &OBP0_PALETTE;
+            palette = &obp0Palette_;
             break;
         case 4:
-            palette = &OBP1_PALETTE;
+            palette = &obp1Palette_;
             break;
         default:
             return;
@@ -703,4 +951,6 @@ void PPU::SetCustomPalette(uint8_t index, uint8_t* data)
             (*palette)[i][j] = data[i*3 + j];
         }
     }
+
+    colorCacheDirty_ = true;
 }
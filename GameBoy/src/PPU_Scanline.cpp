@@ -0,0 +1,283 @@
+#include <PPU.hpp>
+#include <PixelFIFO.hpp>
+#include <array>
+#include <cstdint>
+
+static uint8_t ReverseBits(uint8_t byte)
+{
+    byte = ((byte & 0xF0) >> 4) | ((byte & 0x0F) << 4);
+    byte = ((byte & 0xCC) >> 2) | ((byte & 0x33) << 2);
+    byte = ((byte & 0xAA) >> 1) | ((byte & 0x55) << 1);
+    return byte;
+}
+
+void PPU::SetScanlineRenderer(bool const enabled)
+{
+    if (!enabled && scanlineDeferred_)
+    {
+        ResumePixelFifo();
+    }
+
+    scanlineRenderer_ = enabled;
+}
+
+void PPU::BeginScanline()
+{
+    scanlineDeferred_ = true;
+    auto const& sprites = pixelFifoPtr_->Sprites();
+    uint_fast8_t const numSprites = pixelFifoPtr_->NumSprites();
+
+    // Count the dots the pixel FIFO would spend in mode 3. The background fetcher takes 7 dots to produce the first slice, then
+    // pushes 8 pixels exactly as the last ones are shifted out, so it never stalls pixel output by itself. Only the initial
+    // scroll, switching to the window, and fetching sprites take dots without shifting out a pixel.
+    bool const windowAllowed = WindowEnabled() && (cgbMode_ || WindowAndBackgroundEnabled()) && wyCondition_;
+    uint_fast8_t pixelsToScroll = SCX_ % 8;
+    windowStartX_ = NO_WINDOW;
+    windowStartColumn_ = 0;
+
+    if (windowAllowed && (WX_ <= 7))
+    {
+        windowStartX_ = 0;
+        windowStartColumn_ = 7 - WX_;
+        pixelsToScroll = windowStartColumn_;
+    }
+
+    uint16_t dots = 7 + pixelsToScroll;
+    uint_fast8_t fetcherCycle = pixelsToScroll;
+    uint_fast8_t backgroundPixels = 8 - pixelsToScroll;
+    uint_fast8_t nextSprite = 0;
+
+    for (uint_fast16_t x = 0; x < 160; ++x)
+    {
+        if (windowAllowed && (windowStartX_ == NO_WINDOW) && ((x + 7) >= WX_))
+        {
+            // Background FIFO is cleared and the fetcher starts over on the window.
+            windowStartX_ = x;
+            dots += 7;
+            fetcherCycle = 0;
+            backgroundPixels = 8;
+        }
+
+        while ((nextSprite < numSprites) && (sprites[nextSprite].leftEdge == x))
+        {
+            // Wait for the background fetcher to finish its current tile, then spend 7 dots fetching the sprite.
+            do
+            {
+                ++fetcherCycle;
+                ++dots;
+            } while (fetcherCycle < 7);
+
+            dots += 7;
+            ++nextSprite;
+        }
+
+        ++dots;
+        ++fetcherCycle;
+
+        if (--backgroundPixels == 0)
+        {
+            fetcherCycle = 0;
+            backgroundPixels = 8;
+        }
+    }
+
+    // Pixel FIFO is first clocked on dot 85, and mode 0 starts on the dot after the last pixel is shifted out.
+    mode3EndDot_ = 85 + dots;
+}
+
+void PPU::RenderScanline()
+{
+    scanlineDeferred_ = false;
+    scanlineWindowVisible_ = (windowStartX_ != NO_WINDOW);
+    LX_ = 160;
+
+    if (skipFrame_)
+    {
+        return;
+    }
+
+    std::array<Pixel, 168> spritePixels;
+    uint16_t spriteEnd = 0;
+    auto const& sprites = pixelFifoPtr_->Sprites();
+    uint_fast8_t const numSprites = pixelFifoPtr_->NumSprites();
+    uint_fast8_t nextSprite = 0;
+
+    uint8_t const backgroundY = LY_ + SCY_;
+    uint16_t const backgroundMapRow = BackgroundTileMapBaseAddr() | ((backgroundY / 8) << 5);
+    uint16_t const windowMapRow = WindowTileMapBaseAddr() | ((windowY_ / 8) << 5);
+    TileRow tile = {};
+
+    for (uint_fast16_t x = 0; x < 160; ++x)
+    {
+        while ((nextSprite < numSprites) && (sprites[nextSprite].leftEdge == x))
+        {
+            PushScanlineSprite(sprites[nextSprite], spritePixels, spriteEnd);
+            ++nextSprite;
+        }
+
+        uint_fast8_t column;
+        PixelSource src;
+
+        if (x >= windowStartX_)
+        {
+            column = (x - windowStartX_) + windowStartColumn_;
+            src = PixelSource::WINDOW;
+
+            if ((x == windowStartX_) || ((column % 8) == 0))
+            {
+                tile = FetchBackgroundTileRow(windowMapRow | ((column / 8) % 32), windowY_ % 8);
+            }
+        }
+        else
+        {
+            column = (SCX_ + x) & 0xFF;
+            src = PixelSource::BACKGROUND;
+
+            if ((x == 0) || ((column % 8) == 0))
+            {
+                tile = FetchBackgroundTileRow(backgroundMapRow | (column / 8), backgroundY % 8);
+            }
+        }
+
+        uint_fast8_t const bit = 7 - (column % 8);
+        uint8_t const color = (((tile.high >> bit) & 0x01) << 1) | ((tile.low >> bit) & 0x01);
+        Pixel const bgPixel = {color, tile.palette, 0x00, tile.priority, src};
+        Pixel const spritePixel = (x < spriteEnd) ? spritePixels[x] : Pixel{};
+
+        RenderPixel(pixelFifoPtr_->MixPixels(bgPixel, spritePixel));
+    }
+}
+
+void PPU::ResumePixelFifo()
+{
+    scanlineDeferred_ = false;
+
+    for (uint16_t dot = 85; dot <= dot_; ++dot)
+    {
+        auto pixel = pixelFifoPtr_->Clock();
+
+        if (pixel)
+        {
+            RenderPixel(pixel.value());
+            ++LX_;
+        }
+    }
+}
+
+PPU::TileRow PPU::FetchBackgroundTileRow(uint16_t const mapAddr, uint8_t row) const
+{
+    TileRow tile = {};
+    uint8_t const tileId = VRAM_[0][mapAddr - 0x8000];
+    bool horizontalFlip = false;
+    uint_fast8_t vramBank = 0;
+
+    if (cgbMode_)
+    {
+        uint8_t const attributes = VRAM_[1][mapAddr - 0x8000];
+
+        tile.priority = attributes & 0x80;
+        horizontalFlip = attributes & 0x20;
+        vramBank = (attributes & 0x08) >> 3;
+        tile.palette = attributes & 0x07;
+
+        if (attributes & 0x40)
+        {
+            row = ~row & 0x07;
+        }
+    }
+
+    uint16_t tileAddr;
+
+    if (BackgroundAndWindowTileAddrMode())
+    {
+        tileAddr = 0x8000 | (tileId << 4) | (row << 1);
+    }
+    else if (tileId & 0x80)
+    {
+        tileAddr = 0x8800 | ((tileId & 0x7F) << 4) | (row << 1);
+    }
+    else
+    {
+        tileAddr = 0x9000 | (tileId << 4) | (row << 1);
+    }
+
+    tile.low = VRAM_[vramBank][tileAddr - 0x8000];
+    tile.high = VRAM_[vramBank][(tileAddr | 0x01) - 0x8000];
+
+    if (horizontalFlip)
+    {
+        tile.low = ReverseBits(tile.low);
+        tile.high = ReverseBits(tile.high);
+    }
+
+    return tile;
+}
+
+void PPU::PushScanlineSprite(LineSprite const& sprite, std::array<Pixel, 168>& spritePixels, uint16_t& spriteEnd) const
+{
+    OamEntry const& entry = sprite.entry;
+    uint_fast8_t tileId = entry.tileIndex;
+    uint_fast8_t spriteY = (LY_ + 16) - entry.yPos;
+
+    if (TallSpriteMode())
+    {
+        tileId &= 0xFE;
+
+        if (entry.flags.yFlip)
+        {
+            spriteY = 15 - spriteY;
+        }
+
+        if (spriteY > 7)
+        {
+            ++tileId;
+        }
+    }
+    else if (entry.flags.yFlip)
+    {
+        spriteY = 7 - spriteY;
+    }
+
+    uint_fast8_t const vramBank = cgbMode_ ? entry.flags.cgbTileBank : 0;
+    uint16_t const tileAddr = (tileId << 4) | ((spriteY % 8) << 1);
+    uint8_t const low = VRAM_[vramBank][tileAddr];
+    uint8_t const high = VRAM_[vramBank][tileAddr | 0x01];
+    uint8_t const palette = cgbMode_ ? entry.flags.cgbPalette : entry.flags.dmgPalette;
+
+    // Mirror the sprite FIFO, which holds the pixels from LX up to spriteEnd. Pixels that land within it are merged by position
+    // in the sprite (including any scrolled off the left edge), and the rest are appended after it.
+    uint_fast16_t const x = sprite.leftEdge;
+    uint_fast8_t pixelsToScroll = (x + 8) - entry.xPos;
+    uint_fast16_t queued = (spriteEnd > x) ? (spriteEnd - x) : 0;
+    spriteEnd = x + queued;
+
+    for (uint_fast8_t i = 0; i < 8; ++i)
+    {
+        uint_fast8_t const bit = entry.flags.xFlip ? i : (7 - i);
+        uint8_t const color = (((high >> bit) & 0x01) << 1) | ((low >> bit) & 0x01);
+
+        if (pixelsToScroll > 0)
+        {
+            --pixelsToScroll;
+            continue;
+        }
+
+        Pixel const pixel = {color, palette, sprite.index, static_cast<bool>(entry.flags.priority), PixelSource::SPRITE};
+
+        if (queued > i)
+        {
+            Pixel& queuedPixel = spritePixels[x + i];
+
+            if ((color != 0x00) &&
+                ((queuedPixel.color == 0x00) || (cgbMode_ && (pixel.spritePriority < queuedPixel.spritePriority))))
+            {
+                queuedPixel = pixel;
+            }
+        }
+        else
+        {
+            spritePixels[spriteEnd++] = pixel;
+            ++queued;
+        }
+    }
+}
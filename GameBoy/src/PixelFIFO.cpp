@@ -2,12 +2,10 @@
 #include <PPU.hpp>
 #include <array>
 #include <cstdint>
-#include <deque>
 #include <optional>
-#include <utility>
-#include <vector>
 
 static_assert(sizeof(OamEntry) == 4, "OamEntry must be 4 bytes");
+static_assert(sizeof(Pixel) == 2, "Pixel must be 2 bytes");
 
 PixelFIFO::PixelFIFO(PPU* const ppuPtr) :
     ppuPtr_(ppuPtr)
@@ -23,15 +21,12 @@ void PixelFIFO::Reset()
     pixelsToScroll_ = 0;
 
     // Bg/Window data
-    backgroundFIFO_.clear();
+    backgroundFIFO_.Clear();
 
     // Sprite data
-    spriteFIFO_.clear();
-
-    for (auto& queue : orderedSprites_)
-    {
-        queue.clear();
-    }
+    spriteFIFO_.Clear();
+    numSprites_ = 0;
+    nextSprite_ = 0;
 
     // Pixel fetcher
     backgroundFetcher_ = {};
@@ -58,7 +53,7 @@ std::optional<Pixel> PixelFIFO::Clock()
             {
                 fetchingWindow_ = true;
                 backgroundFetcher_ = {};
-                backgroundFIFO_.clear();
+                backgroundFIFO_.Clear();
             }
 
             ClockBackgroundFetcher();
@@ -68,7 +63,7 @@ std::optional<Pixel> PixelFIFO::Clock()
         {
             if (pixelsToScroll_ > 0)
             {
-                backgroundFIFO_.pop_front();
+                backgroundFIFO_.PopFront();
                 ClockBackgroundFetcher();
                 --pixelsToScroll_;
             }
@@ -85,11 +80,11 @@ std::optional<Pixel> PixelFIFO::Clock()
             {
                 fetchingWindow_ = true;
                 backgroundFetcher_ = {};
-                backgroundFIFO_.clear();
+                backgroundFIFO_.Clear();
                 fifoState_ = FifoState::SWITCHING_TO_WINDOW;
                 ClockBackgroundFetcher();
             }
-            else if (!orderedSprites_[ppuPtr_->LX_].empty())
+            else if ((nextSprite_ < numSprites_) && (sprites_[nextSprite_].leftEdge == ppuPtr_->LX_))
             {
                 fifoState_ = FifoState::SPRITE_AWAITING_FETCHER;
                 ClockBackgroundFetcher();
@@ -107,20 +102,32 @@ std::optional<Pixel> PixelFIFO::Clock()
     return {};
 }
 
-void PixelFIFO::LoadSprites(std::vector<OamEntry> const& sprites)
+void PixelFIFO::LoadSprites(std::array<OamEntry, MAX_SPRITES_PER_LINE> const& sprites, uint8_t const numSprites)
 {
     Reset();
     uint_fast8_t index = 0;
 
-    for (auto const& sprite : sprites)
+    for (uint_fast8_t i = 0; i < numSprites; ++i)
     {
+        OamEntry const& sprite = sprites[i];
+
         if ((sprite.xPos == 0) || (sprite.xPos >= 168))
         {
             continue;
         }
 
-        uint_fast8_t leftEdge = (sprite.xPos < 8) ? 0 : (sprite.xPos - 8);
-        orderedSprites_[leftEdge].push_back({sprite, index});
+        // Insert after any sprites with the same or an earlier left edge, keeping OAM order among equal left edges.
+        uint8_t const leftEdge = (sprite.xPos < 8) ? 0 : (sprite.xPos - 8);
+        uint_fast8_t position = numSprites_;
+
+        while ((position > 0) && (sprites_[position - 1].leftEdge > leftEdge))
+        {
+            sprites_[position] = sprites_[position - 1];
+            --position;
+        }
+
+        sprites_[position] = {sprite, index, leftEdge};
+        ++numSprites_;
         ++index;
     }
 }
@@ -149,9 +156,9 @@ void PixelFIFO::ClockSpriteFetcher()
             break;
         case 2:     // Get tile
         {
-            auto spriteInfo = orderedSprites_[ppuPtr_->LX_].front();
-            OamEntry spriteToLoad = spriteInfo.first;
-            spriteBeingLoadedIndex_ = spriteInfo.second;
+            LineSprite const& spriteInfo = sprites_[nextSprite_];
+            OamEntry spriteToLoad = spriteInfo.entry;
+            spriteBeingLoadedIndex_ = spriteInfo.index;
             pixelsToScroll_ = (ppuPtr_->LX_ + 8) - spriteToLoad.xPos;
 
             spriteFetcher_.tileId = spriteToLoad.tileIndex;
@@ -184,7 +191,7 @@ void PixelFIFO::ClockSpriteFetcher()
 
             spriteFetcher_.tileAddr = 0x8000 | (spriteFetcher_.tileId << 4) | ((spriteY % 8) << 1);
 
-            orderedSprites_[ppuPtr_->LX_].pop_front();
+            ++nextSprite_;
             break;
         }
         case 3:
@@ -238,7 +245,7 @@ void PixelFIFO::PushSpritePixels()
         Pixel pixel = {color, spriteFetcher_.palette, spriteBeingLoadedIndex_, spriteFetcher_.priority, PixelSource::SPRITE};
         uint_fast8_t size = i + 1;
 
-        if (spriteFIFO_.size() >= size)
+        if (spriteFIFO_.Size() >= size)
         {
             if (color != 0x00)
             {
@@ -250,21 +257,19 @@ void PixelFIFO::PushSpritePixels()
         }
         else
         {
-            spriteFIFO_.push_back(pixel);
+            spriteFIFO_.PushBack(pixel);
         }
     }
 }
 
 Pixel PixelFIFO::GetSpritePixel()
 {
-    if (spriteFIFO_.empty())
+    if (spriteFIFO_.Empty())
     {
         return {};
     }
 
-    auto pixel = spriteFIFO_.front();
-    spriteFIFO_.pop_front();
-    return pixel;
+    return spriteFIFO_.PopFront();
 }
 
 void PixelFIFO::ClockBackgroundFetcher()
@@ -352,7 +357,7 @@ void PixelFIFO::ClockBackgroundFetcher()
             break;
         default:    // Attempt to push
         {
-            if (backgroundFIFO_.empty())
+            if (backgroundFIFO_.Empty())
             {
                 PushBackgroundPixels();
                 backgroundFetcher_ = {};
@@ -401,21 +406,24 @@ void PixelFIFO::PushBackgroundPixels()
             backgroundFetcher_.tileDataLow <<= 1;
         }
 
-        backgroundFIFO_.push_back({color, backgroundFetcher_.palette, 0x00, backgroundFetcher_.priority, src});
+        backgroundFIFO_.PushBack({color, backgroundFetcher_.palette, 0x00, backgroundFetcher_.priority, src});
     }
 }
 
 Pixel PixelFIFO::GetBackgroundPixel()
 {
-    auto pixel = backgroundFIFO_.front();
-    backgroundFIFO_.pop_front();
-    return pixel;
+    return backgroundFIFO_.PopFront();
 }
 
 Pixel PixelFIFO::GetPixel()
 {
     Pixel bgPixel = GetBackgroundPixel();
     Pixel spritePixel = GetSpritePixel();
+    return MixPixels(bgPixel, spritePixel);
+}
+
+Pixel PixelFIFO::MixPixels(Pixel const bgPixel, Pixel const spritePixel) const
+{
     bool bgEnabled = ppuPtr_->cgbMode_ ? true : ppuPtr_->WindowAndBackgroundEnabled();
     bool spritesEnabled = ppuPtr_->SpritesEnabled();
 
@@ -0,0 +1,111 @@
+#include <Scheduler.hpp>
+#include <cstdint>
+
+void Scheduler::Reset()
+{
+    position_.fill(NOT_SCHEDULED);
+    size_ = 0;
+}
+
+void Scheduler::Schedule(Event const event, uint64_t const dot, Phase const phase)
+{
+    Cancel(event);
+    Place(size_, {Key(dot, phase), event});
+    ++size_;
+    SiftUp(size_ - 1);
+}
+
+void Scheduler::Cancel(Event const event)
+{
+    uint8_t const index = position_[static_cast<uint8_t>(event)];
+
+    if (index != NOT_SCHEDULED)
+    {
+        RemoveAt(index);
+    }
+}
+
+Event Scheduler::PopDueEvent()
+{
+    Event const event = heap_[0].event;
+    RemoveAt(0);
+    return event;
+}
+
+void Scheduler::RemoveAt(uint8_t const index)
+{
+    position_[static_cast<uint8_t>(heap_[index].event)] = NOT_SCHEDULED;
+    --size_;
+
+    if (index == size_)
+    {
+        return;
+    }
+
+    Place(index, heap_[size_]);
+
+    if ((index > 0) && (heap_[index].key < heap_[(index - 1) / 2].key))
+    {
+        SiftUp(index);
+    }
+    else
+    {
+        SiftDown(index);
+    }
+}
+
+void Scheduler::SiftUp(uint8_t index)
+{
+    Entry const entry = heap_[index];
+
+    while (index > 0)
+    {
+        uint8_t const parent = (index - 1) / 2;
+
+        if (heap_[parent].key <= entry.key)
+        {
+            break;
+        }
+
+        Place(index, heap_[parent]);
+        index = parent;
+    }
+
+    Place(index, entry);
+}
+
+void Scheduler::SiftDown(uint8_t index)
+{
+    Entry const entry = heap_[index];
+
+    while (true)
+    {
+        uint8_t child = (2 * index) + 1;
+
+        if (child >= size_)
+        {
+            break;
+        }
+
+        if (((child + 1) < size_) && (heap_[child + 1].key < heap_[child].key))
+        {
+            ++child;
+        }
+
+        if (entry.key <= heap_[child].key)
+        {
+            break;
+        }
+
+        Place(index, heap_[child]);
+        index = child;
+    }
+
+    Place(index, entry);
+}
+
+void Scheduler::Place(uint8_t const index, Entry const entry)
+{
+    heap_[index] = entry;
+    position_[static_cast<uint8_t>(entry.event)] = index;
+}
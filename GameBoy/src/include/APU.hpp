@@ -4,8 +4,12 @@
 #include <Channel2.hpp>
 #include <Channel3.hpp>
 #include <Channel4.hpp>
+#include <BlipBuffer.hpp>
+#include <array>
 #include <cstdint>
 #include <fstream>
+#include <utility>
+#include <vector>
 
 class APU
 {
@@ -20,18 +24,36 @@ public:
     /// @param[in] skipBootRom Whether its being powered on into the boot ROM or straight into game.
     void PowerOn(bool skipBootRom);
 
-    /// @brief Set the sample rate used for audio playback. This is used to set parameters of the low pass filter.
-    /// @param sampleRate Sample rate to downsample to.
+    /// @brief Set the sample rate used for audio playback. Throws away any pending output, sets the high pass filter up for
+    ///        the new rate, and makes room to drain a fraction of a second of audio at that rate without allocating. Changes
+    ///        are still spread over however many samples DrainSampleBuffer is asked for, so the rate may drift slightly from
+    ///        this to keep up with the emulation.
+    /// @param sampleRate Sample rate to render at, in Hz. Must be positive.
     void SetSampleRate(int sampleRate);
 
-    /// @brief Apply low pass filters and downsampling to sample buffers and fill playback buffer.
+    /// @brief Render the changes in output since the last drain as band-limited steps and fill the playback buffer. The
+    ///        M-cycles run since the last drain are spread evenly over the buffer.
     /// @param buffer Pointer to buffer to fill.
     /// @param count Buffer size. Number of samples to provide is half of this due to stereo playback.
     void DrainSampleBuffer(float* buffer, int count);
 
-    /// @brief Clock the DIV register and advance the frame sequencer if necessary.
+    /// @brief Throw away any pending output. Used when running without audio output.
+    void DiscardSamples();
+
+    /// @brief Only check whether the mixed output changed once every few M-cycles. The channels are still clocked every M-cycle,
+    ///        so this only reduces the cost of producing output, e.g. when running many times faster than real time.
+    /// @param factor Check one of every factor M-cycles. 1 checks every M-cycle (default), 0 produces no output at all.
+    void SetSampleDecimation(int factor);
+
+    /// @brief Clock the DIV register several times and advance the frame sequencer for each falling edge of its APU bit.
+    /// @param[in] ticks Number of times DIV's internal divider is clocked.
     /// @param[in] doubleSpeed True if system is running in double speed mode. Used to determine when to advance frame sequencer.
-    void ClockDIV(bool doubleSpeed);
+    void AdvanceDIV(uint64_t ticks, bool doubleSpeed);
+
+    /// @brief Get how many more times DIV's internal divider must be clocked before the frame sequencer next advances.
+    /// @param[in] doubleSpeed True if system is running in double speed mode. Used to determine which DIV bit is watched.
+    /// @return Number of clocks until the next falling edge of DIV's APU bit.
+    uint_fast16_t TicksUntilFrameSequencer(bool doubleSpeed) const;
 
     /// @brief Reset the DIV register and advance the frame sequencer if necessary.
     /// @param[in] doubleSpeed True if system is running in double speed mode. Used to determine whether to advance frame sequencer.
@@ -66,7 +88,7 @@ public:
 
     /// @brief Choose whether to output
     /// @param[in] monoAudio True to use mono, false to use stereo.
-    void SetMonoAudio(bool monoAudio) { monoAudio_ = monoAudio; }
+    void SetMonoAudio(bool monoAudio) { monoAudio_ = monoAudio; mixDirty_ = true; }
 
     /// @brief Set the volume of the APU output.
     /// @param[in] volume Volume of output (between 0.0 and 1.0).
@@ -78,9 +100,23 @@ private:
     /// @return Output from high pass filter.
     float HPF(float input);
 
+    /// @brief Mix the current output of each channel according to the panning and volume settings.
+    /// @return Left and right output, before the high pass filter and master volume are applied.
+    std::pair<float, float> Mix() const;
+
+    /// @brief Record a change in the mixed output.
+    /// @param cycle M-cycle since the last drain on which the output changed.
+    /// @param left New left output.
+    /// @param right New right output.
+    void SetOutput(uint32_t cycle, float left, float right);
+
     /// @brief Clock the frame sequencer.Clocks the envelope, frequency sweep, and length timer of channels that support those.
     void AdvanceFrameSequencer();
 
+    /// @brief Get the number of DIV divider clocks between each frame sequencer step.
+    /// @param[in] doubleSpeed True if DIV bit 5 is watched instead of bit 4.
+    static uint_fast16_t FrameSequencerPeriod(bool doubleSpeed) { return doubleSpeed ? 0x1000 : 0x0800; }
+
     // GUI overrides
     bool monoAudio_;
     float volume_;
@@ -95,6 +131,7 @@ private:
     float capacitor_;
 
     // APU DIV
+    static constexpr uint_fast16_t DIV_COUNTER_MASK = 0x3FFF;  // DIV and its divider form a 14-bit counter
     uint8_t divDivider_;
     uint8_t envelopeDivider_;
     uint8_t soundLengthDivider_;
@@ -118,6 +155,25 @@ private:
     uint8_t NR50_;
     uint8_t NR51_;
 
+    // Output
+    struct AmplitudeChange
+    {
+        uint32_t cycle;  // M-cycles since the last drain
+        float left;      // Change in left output
+        float right;     // Change in right output
+    };
+
+    std::vector<AmplitudeChange> amplitudeChanges_;  // Changes in mixed output since the last drain
+    uint32_t sampleClock_;  // M-cycles since the last drain
+    std::array<float, 4> channelSamples_;  // Channel outputs the current mixed output was calculated from
+    bool mixDirty_;  // Mixed output must be recalculated even if no channel output changed, e.g. after a register write
+    float outputLeft_;
+    float outputRight_;
+    BlipBuffer blip_;
+    float hpfChargeFactor_;  // Fraction of the capacitor's charge kept across one output sample
+    int sampleDecimation_;
+    int decimationCounter_;
+
     // Channels
     Channel1 channel1_;
     Channel2 channel2_;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// @brief Lock-free single-producer/single-consumer queue of audio samples. One thread may write while another reads, and
+///        neither ever blocks or allocates. Any other use, e.g. two threads writing, is not safe.
+class AudioRingBuffer
+{
+public:
+    /// @brief Create an empty ring buffer.
+    /// @param capacity Minimum number of samples the buffer can hold. Rounded up to a power of 2.
+    explicit AudioRingBuffer(size_t capacity);
+
+    /// @brief Add samples to the buffer. Only call from the producer thread.
+    /// @param[in] samples Samples to add.
+    /// @param count Number of samples to add.
+    /// @return Number of samples added. Less than count if the buffer filled up.
+    size_t Write(float const* samples, size_t count);
+
+    /// @brief Remove samples from the buffer. Only call from the consumer thread.
+    /// @param[out] samples Buffer to write samples to.
+    /// @param count Maximum number of samples to remove.
+    /// @return Number of samples removed. Less than count if the buffer ran dry.
+    size_t Read(float* samples, size_t count);
+
+    /// @brief Get the number of samples waiting to be read. From the producer's side this may be an overestimate, and from the
+    ///        consumer's side an underestimate, since the other thread may be working on the buffer at the same time.
+    /// @return Number of samples in the buffer.
+    size_t Size() const;
+
+    /// @brief Get the number of samples the buffer can hold.
+    /// @return Capacity in samples.
+    size_t Capacity() const { return buffer_.size(); }
+
+private:
+    std::vector<float> buffer_;
+    size_t mask_;
+
+    // Total samples ever written and read. Each is only modified by one thread, and they're kept on separate cache lines so
+    // that the producer and consumer don't slow each other down.
+    alignas(64) std::atomic<size_t> writeCount_;
+    alignas(64) std::atomic<size_t> readCount_;
+};
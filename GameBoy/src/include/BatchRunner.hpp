@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/// @brief A single headless run of a game.
+struct BatchJob
+{
+    std::filesystem::path romPath;
+    std::filesystem::path saveStatePath;    // Optional save state to load after powering on
+    std::filesystem::path inputScriptPath;  // Optional input script to play back
+    std::filesystem::path ramDumpPath;      // Optional file to write WRAM and HRAM to once the job finishes
+    int frames;                             // Number of frames to run for
+};
+
+/// @brief Outcome of a BatchJob.
+struct BatchResult
+{
+    bool success;        // False if the ROM, save state, or input script couldn't be loaded
+    int framesRun;       // Number of frames run
+    uint64_t cyclesRun;  // Number of machine cycles run
+    uint64_t frameHash;  // 64-bit FNV-1a hash of the final frame buffer
+};
+
+/// @brief Hash a frame buffer with 64-bit FNV-1a.
+/// @param[in] frameBuffer Frame buffer to hash.
+/// @param[in] size Size of frame buffer in bytes.
+/// @return Hash of the frame.
+uint64_t HashFrame(uint8_t const* frameBuffer, size_t size);
+
+/// @brief Run a job to completion on the calling thread. The job gets its own GameBoy, and nothing is written to disk other
+///        than the optional RAM dump.
+///
+///        An input script is a text file with one line per change in joypad state, formatted as a frame number followed by
+///        the buttons held from that frame onward (any of up, down, left, right, start, select, b, a). A line with just a frame
+///        number releases every button. Lines must be in frame order, and blank lines or ones starting with # are ignored.
+/// @param[in] job Job to run.
+/// @return Result of the job.
+BatchResult RunBatchJob(BatchJob const& job);
+
+/// @brief Run a set of jobs across a work-stealing thread pool.
+/// @param[in] jobs Jobs to run.
+/// @param[in] numThreads Number of worker threads. If 0, use one per hardware thread.
+/// @return Result of each job, in the same order as jobs.
+std::vector<BatchResult> RunBatch(std::vector<BatchJob> const& jobs, unsigned int numThreads);
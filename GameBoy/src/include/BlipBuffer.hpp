@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// @brief Band-limited synthesis of a stereo signal that only changes in steps. Instead of sampling the signal at a high rate
+///        and filtering it down, each change in amplitude adds a band-limited step to the output at the output sample rate.
+///        Output is delayed by half the kernel width.
+///
+///        Left and right are kept interleaved so that each step is added to both with one fixed-length loop the compiler can
+///        vectorize. Storage is allocated up front, so adding steps and reading samples never allocates unless more samples are
+///        requested at once than ever before.
+class BlipBuffer
+{
+public:
+    BlipBuffer();
+
+    /// @brief Add a change in amplitude.
+    /// @param time When the change occurs, in output samples from the start of the next ReadSamples call.
+    /// @param left Change in left amplitude.
+    /// @param right Change in right amplitude.
+    void AddDelta(double time, float left, float right);
+
+    /// @brief Render output samples and remove them from the buffer. Steps added past the samples read are kept for the
+    ///        next call, with their time shifted back by count.
+    /// @param out Buffer to write interleaved stereo samples to. Must hold 2 * count floats.
+    /// @param count Number of stereo samples to read.
+    void ReadSamples(float* out, int count);
+
+    /// @brief Remove all pending steps and jump straight to an amplitude.
+    /// @param left Left amplitude to output from now on.
+    /// @param right Right amplitude to output from now on.
+    void Reset(float left, float right);
+
+    /// @brief Make sure steps can be added, and samples read, up to a given time without allocating.
+    /// @param time Latest time a step will be added at or number of samples that will be read at once, in output samples.
+    void Reserve(size_t time);
+
+private:
+    static constexpr int KERNEL_WIDTH = 16;  // Output samples each step is spread over
+    static constexpr int PHASES = 64;  // Number of precomputed step positions between output samples
+    static constexpr size_t INITIAL_CAPACITY = 8192;  // Stereo samples that can be read at once without allocating
+
+    using Kernel = std::array<float, 2 * KERNEL_WIDTH>;
+
+    /// @brief Get the kernels used to add a step part way between two output samples.
+    /// @return PHASES + 1 kernels, from a step on the first sample to a step on the next one. Each is the band-limited impulse
+    ///         of a step, summing to 1, with every tap repeated for left and right.
+    static std::array<Kernel, PHASES + 1> const& Kernels();
+
+    std::vector<float> deltas_;  // Band-limited impulses of each step, added up per interleaved output sample
+    size_t end_;  // One past the last stereo sample that may hold a nonzero delta
+    std::array<float, 2> amplitude_;  // Current left and right output, the running sum of everything read so far
+};
@@ -3,14 +3,47 @@
 #include <CPU_Registers.hpp>
 #include <cstdint>
 #include <fstream>
-#include <functional>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
-class CPU
+class GameBoy;
+
+/// @brief Registers and execution state of the CPU. Plain data, so that it can be copied as a snapshot.
+struct CpuState
+{
+    // Instruction being executed
+    CPU_Registers reg_;
+    uint8_t opCode_;
+    uint8_t mCycle_;
+    bool prefixedOpCode_;
+    bool prefixedInstruction_;
+    uint8_t cmdData8_;
+    uint16_t cmdData16_;
+
+    // Interrupt variables
+    bool interruptsEnabled_;
+    bool setInterruptsEnabled_;
+    bool setInterruptsDisabled_;
+    bool interruptBeingProcessed_;
+    uint8_t interruptCountdown_;
+    uint16_t interruptAddr_;
+
+    // Halt state variables
+    bool halted_;
+    bool haltBug_;
+    uint8_t numPendingInterrupts_;
+
+    // Set by illegal opcodes
+    bool locked_;
+};
+
+static_assert(std::is_trivially_copyable_v<CpuState>);
+
+class CPU : private CpuState
 {
 public:
-    // CPU requires a Read/Write function in order to operate, so delete default constructors.
+    // CPU requires a bus in order to operate, so delete default constructors.
     CPU() = delete;
     CPU(CPU const&) = delete;
     CPU& operator=(CPU const&) = delete;
@@ -18,12 +51,9 @@ public:
     CPU& operator=(CPU&&) = delete;
 
     /// @brief Create an instance of a Sharp SM83 CPU.
-    /// @param readFunction Function wrapper to handle reads.
-    /// @param writeFunction Function wrapper to handle writes.
-    CPU(std::function<uint8_t(uint16_t)> readFunction,
-        std::function<void(uint16_t, uint8_t)> writeFunction,
-        std::function<void()> acknowledgeInterruptFunction,
-        std::function<std::pair<bool, bool>(bool)> stopFunction);
+    /// @param bus Game Boy that handles reads, writes, interrupt acknowledgement, and STOP for the CPU. Calls into it are
+    ///            statically dispatched so that they can be inlined into the instruction handlers.
+    CPU(GameBoy& bus);
 
     /// @brief Reset the state of the CPU to as if it just started.
     /// @param[in] skipBootRom Whether the CPU is being powered on to start running the boot ROM.
@@ -40,24 +70,43 @@ public:
     /// @brief Use to force exit halt mode.
     void ExitHalt() { halted_ = false; }
 
+    /// @brief Check whether the CPU is halted with nothing to do until an interrupt becomes pending.
+    /// @return True if halted and no change to IME is counting down.
+    bool Halted() const { return halted_ && !setInterruptsEnabled_ && !setInterruptsDisabled_; }
+
     bool InBetweenInstructions() const { return mCycle_ == 0; };
 
+    /// @brief Check whether the CPU has locked up by executing an illegal opcode. It never finishes an instruction again.
+    /// @return True if locked up.
+    bool Locked() const { return locked_; }
+
+    /// @brief Get a copy of the CPU's registers and execution state, e.g. to snapshot it.
+    /// @return Current CPU state.
+    CpuState GetState() const { return *this; }
+
+    /// @brief Restore the CPU's registers and execution state from a snapshot.
+    /// @param state State previously returned by GetState.
+    void SetState(CpuState const& state) { static_cast<CpuState&>(*this) = state; }
+
     bool IsSerializable() const;
     void Serialize(std::ofstream& out);
     void Deserialize(std::ifstream& in);
 
 private:
-    /// @brief Wrapper for Read function.
-    std::function<uint8_t(uint16_t)> Read;
+    /// @brief Forward a read to the bus.
+    uint8_t Read(uint16_t addr);
 
-    /// @brief Wrapper for Write function.
-    std::function<void(uint16_t, uint8_t)> Write;
+    /// @brief Forward a write to the bus.
+    void Write(uint16_t addr, uint8_t data);
 
-    /// @brief Function to call when servicing an interrupt.
-    std::function<void()> AcknowledgeInterrupt;
+    /// @brief Notify the bus that the pending interrupt is being serviced.
+    void AcknowledgeInterrupt();
 
-    /// @brief Wrapper for function to call when executing Stop command.
-    std::function<std::pair<bool, bool>(bool)> ReportStop;
+    /// @brief Let the bus determine what happens when executing a STOP command.
+    std::pair<bool, bool> ReportStop(bool IME);
+
+    /// @brief Bus that this CPU is connected to.
+    GameBoy& bus_;
 
     /// @brief Read the PC, then increment it.
     /// @return The value pointed to by the current PC address.
@@ -74,6 +123,9 @@ private:
     /// @brief Determine which function to execute based on current OpCode.
     void DecodeOpCode();
 
+    /// @brief Run the next M-cycle of the multi-cycle instruction selected by the current OpCode.
+    void ExecuteInstruction();
+
     /// @brief Save the current PC and then set it to the correct interrupt address.
     /// @param addr New address to set PC to.
     void InterruptHandler(uint16_t addr);
@@ -170,25 +222,4 @@ private:
     void Restart(uint8_t addr);
     void Return(bool enableInterrupts);
     void ReturnConditional(bool condition);
-
-    // State variables
-    CPU_Registers reg_;
-    uint8_t opCode_;
-    uint8_t mCycle_;
-    bool prefixedOpCode_;
-    std::function<void()> instruction_;
-    uint8_t cmdData8_;
-    uint16_t cmdData16_;
-
-    // Interrupt variables
-    bool interruptsEnabled_;
-    bool setInterruptsEnabled_;
-    bool setInterruptsDisabled_;
-    bool interruptBeingProcessed_;
-    uint8_t interruptCountdown_;
-
-    // Halt state variables
-    bool halted_;
-    bool haltBug_;
-    uint8_t numPendingInterrupts_;
 };
@@ -11,14 +11,7 @@ constexpr uint8_t CARRY_FLAG = 0x10;
 class CPU_Registers
 {
 public:
-    CPU_Registers() :
-        A(AF_.high_), F(AF_.low_), AF(AF_.pair_),
-        B(BC_.high_), C(BC_.low_), BC(BC_.pair_),
-        D(DE_.high_), E(DE_.low_), DE(DE_.pair_),
-        H(HL_.high_), L(HL_.low_), HL(HL_.pair_)
-    {
-        Reset();
-    }
+    CPU_Registers() { Reset(); }
 
     void Reset()
     {
@@ -37,21 +30,52 @@ public:
     void Serialize(std::ofstream& out);
     void Deserialize(std::ifstream& in);
 
-    uint8_t& A;
-    uint8_t& F;
-    uint16_t& AF;
+    // Each pair of 8-bit registers shares storage with the 16-bit register they form. The low register comes first, matching
+    // the byte order of the 16-bit one on little-endian hosts.
+
+    union
+    {
+        struct
+        {
+            uint8_t F;
+            uint8_t A;
+        };
+
+        uint16_t AF;
+    };
+
+    union
+    {
+        struct
+        {
+            uint8_t C;
+            uint8_t B;
+        };
+
+        uint16_t BC;
+    };
+
+    union
+    {
+        struct
+        {
+            uint8_t E;
+            uint8_t D;
+        };
 
-    uint8_t& B;
-    uint8_t& C;
-    uint16_t& BC;
+        uint16_t DE;
+    };
 
-    uint8_t& D;
-    uint8_t& E;
-    uint16_t& DE;
+    union
+    {
+        struct
+        {
+            uint8_t L;
+            uint8_t H;
+        };
 
-    uint8_t& H;
-    uint8_t& L;
-    uint16_t& HL;
+        uint16_t HL;
+    };
 
     uint16_t SP;
     uint16_t PC;
@@ -108,24 +132,4 @@ public:
             F &= ~CARRY_FLAG;
         }
     }
-
-private:
-    struct RegisterPair
-    {
-        union
-        {
-            struct
-            {
-                uint8_t low_;
-                uint8_t high_;
-            };
-
-            uint16_t pair_;
-        };
-    };
-
-    RegisterPair AF_;
-    RegisterPair BC_;
-    RegisterPair DE_;
-    RegisterPair HL_;
 };
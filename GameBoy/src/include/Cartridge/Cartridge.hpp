@@ -1,8 +1,25 @@
 #pragma once
 
+#include <Cartridge/RomImage.hpp>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <vector>
+
+namespace BankChange
+{
+/// @brief Flags returned by Cartridge::WriteROM for each part of the memory map whose mapped bank may have changed.
+enum : uint8_t
+{
+    NONE = 0x00,
+    ROM_0 = 0x01,  // $0000-$3FFF
+    ROM_X = 0x02,  // $4000-$7FFF
+    RAM = 0x04,    // $A000-$BFFF
+};
+}
 
 class Cartridge
 {
@@ -10,19 +27,65 @@ public:
     virtual ~Cartridge() {}
     virtual void Reset() = 0;
 
-    virtual uint8_t ReadROM(uint16_t addr) = 0;
-    virtual void WriteROM(uint16_t addr, uint8_t data) = 0;
+    /// @brief Read from cartridge ROM through the banks currently mapped in.
+    /// @param addr Address in $0000-$7FFF.
+    /// @return Byte of ROM mapped to that address.
+    uint8_t ReadROM(uint16_t addr) const { return ROM_[romBankOffset_[addr >> 14] + (addr & 0x3FFF)]; }
+
+    // Everything below stays virtual. Mapped RAM banks are read and written through GameBoy's memory map, so these only run on
+    // bank switches and on accesses to disabled RAM or the MBC3 RTC, and switching on the mapper type instead of going through
+    // the vtable measured slightly slower in the bus/write/mbc*/rom_bank benchmarks.
+
+    /// @brief Write to one of the cartridge's bank registers.
+    /// @param addr Address in $0000-$7FFF.
+    /// @param data Byte to write.
+    /// @return BankChange flags for the parts of the memory map that must be remapped.
+    virtual uint8_t WriteROM(uint16_t addr, uint8_t data) = 0;
 
     virtual uint8_t ReadRAM(uint16_t addr) = 0;
     virtual void WriteRAM(uint16_t addr, uint8_t data) = 0;
 
+    /// @brief Get the ROM bank that reads from part of $0000-$7FFF currently return data from.
+    /// @param addr Address in the half of ROM space to check.
+    /// @return Pointer to the start of the 16 KiB bank mapped to that half.
+    uint8_t const* MappedRomBank(uint16_t addr) const { return ROM_ + romBankOffset_[addr >> 14]; }
+
+    /// @brief Get the RAM bank that reads from $A000-$BFFF currently return data from.
+    /// @return Pointer to the start of the 8 KiB bank, or nullptr if reads must go through ReadRAM.
+    virtual uint8_t const* MappedRamReadBank() const = 0;
+
+    /// @brief Get the RAM bank that writes to $A000-$BFFF currently store data in.
+    /// @return Pointer to the start of the 8 KiB bank, or nullptr if writes must go through WriteRAM.
+    virtual uint8_t* MappedRamWriteBank() = 0;
+
     virtual void SaveRAM() = 0;
 
     virtual void Serialize(std::ofstream& out) = 0;
     virtual void Deserialize(std::ifstream& in) = 0;
 
 protected:
+    static constexpr size_t ROM_BANK_SIZE = 0x4000;
+
+    /// @brief Use a ROM image as this cartridge's ROM.
+    /// @param rom Image of the ROM file, shared with any other cartridge that has the same file loaded.
+    /// @param romBankCount Total number of 16 KiB banks in the ROM according to its header.
+    void LoadROM(std::shared_ptr<RomImage const> rom, uint16_t romBankCount);
+
+    /// @brief Select which ROM banks are mapped to $0000-$3FFF and $4000-$7FFF.
+    /// @param lowerBank Bank mapped to $0000-$3FFF.
+    /// @param upperBank Bank mapped to $4000-$7FFF.
+    void MapRomBanks(size_t lowerBank, size_t upperBank)
+    {
+        romBankOffset_ = {lowerBank * ROM_BANK_SIZE, upperBank * ROM_BANK_SIZE};
+    }
+
     bool containsRAM_;
     bool batteryBacked_;
     std::filesystem::path savePath_;
+
+private:
+    std::shared_ptr<RomImage const> romImage_;
+    std::vector<uint8_t> paddedROM_;  // Copy of a ROM file that's smaller than its header claims, padded out to full size
+    uint8_t const* ROM_;
+    std::array<size_t, 2> romBankOffset_;  // Offset into ROM_ of the bank mapped to each half of ROM space
 };
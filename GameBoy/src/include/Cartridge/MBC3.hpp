@@ -6,16 +6,16 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 namespace fs = std::filesystem;
 using TimePoint = std::chrono::system_clock::time_point;
 
-class MBC3 : public virtual Cartridge
+class MBC3 final : public Cartridge
 {
 public:
-    MBC3(std::array<uint8_t, 0x4000> const& bank0,
-         std::ifstream& rom,
+    MBC3(std::shared_ptr<RomImage const> rom,
          fs::path savePath,
          uint8_t cartridgeType,
          uint16_t romBankCount,
@@ -25,21 +25,25 @@ public:
 
     void Reset() override;
 
-    uint8_t ReadROM(uint16_t addr) override;
-    void WriteROM(uint16_t addr, uint8_t data) override;
+    uint8_t WriteROM(uint16_t addr, uint8_t data) override;
 
     uint8_t ReadRAM(uint16_t addr) override;
     void WriteRAM(uint16_t addr, uint8_t data) override;
 
+    uint8_t const* MappedRamReadBank() const override;
+    uint8_t* MappedRamWriteBank() override;
+
     void SaveRAM() override;
 
     void Serialize(std::ofstream& out) override;
     void Deserialize(std::ifstream& in) override;
 
 private:
+    /// @brief Map ROM banks according to the current bank registers.
+    void UpdateRomBanks();
+
     void UpdateInternalRTC();
 
-    std::vector<std::array<uint8_t, 0x4000>> ROM_;
     std::vector<std::array<uint8_t, 0x2000>> RAM_;
 
     // Bank counts
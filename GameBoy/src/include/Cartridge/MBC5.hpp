@@ -4,15 +4,15 @@
 #include <array>
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 namespace fs = std::filesystem;
 
-class MBC5 : public virtual Cartridge
+class MBC5 final : public Cartridge
 {
 public:
-    MBC5(std::array<uint8_t, 0x4000> const& bank0,
-         std::ifstream& rom,
+    MBC5(std::shared_ptr<RomImage const> rom,
          fs::path savePath,
          uint8_t cartridgeType,
          uint16_t romBankCount,
@@ -22,20 +22,24 @@ public:
 
     void Reset() override;
 
-    uint8_t ReadROM(uint16_t addr) override;
-    void WriteROM(uint16_t addr, uint8_t data) override;
+    uint8_t WriteROM(uint16_t addr, uint8_t data) override;
 
     uint8_t ReadRAM(uint16_t addr) override;
     void WriteRAM(uint16_t addr, uint8_t data) override;
 
+    uint8_t const* MappedRamReadBank() const override;
+    uint8_t* MappedRamWriteBank() override;
+
     void SaveRAM() override;
 
     void Serialize(std::ofstream& out) override;
     void Deserialize(std::ifstream& in) override;
 
 private:
+    /// @brief Map ROM banks according to the current bank registers.
+    void UpdateRomBanks();
+
     // Memory
-    std::vector<std::array<uint8_t, 0x4000>> ROM_;
     std::vector<std::array<uint8_t, 0x2000>> RAM_;
 
     // Cart info
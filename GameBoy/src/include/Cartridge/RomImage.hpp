@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+/// @brief Read-only image of a ROM file. The file is memory mapped where possible, and images are shared between every
+///        cartridge that has the same file loaded, so running many instances of one game only keeps one copy of its ROM.
+class RomImage
+{
+public:
+    /// @brief Get the image of a ROM file, reusing the one already loaded if another cartridge holds the same unmodified file.
+    /// @param romPath Path to ROM file.
+    /// @return Shared image of the file, or nullptr if it couldn't be opened or is empty.
+    static std::shared_ptr<RomImage const> Open(std::filesystem::path const& romPath);
+
+    RomImage(RomImage const&) = delete;
+    RomImage& operator=(RomImage const&) = delete;
+    ~RomImage();
+
+    uint8_t const* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+    RomImage() = default;
+
+    /// @brief Map the file into memory, or read it into memory if mapping isn't possible.
+    /// @param romPath Path to ROM file.
+    /// @return True if the file's contents are now available.
+    bool Load(std::filesystem::path const& romPath);
+
+    uint8_t const* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_;  // Contents of the file if it couldn't be mapped
+};
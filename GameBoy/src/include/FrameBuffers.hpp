@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Triple-buffered frames shared between the PPU and whoever displays them. The PPU renders into the back buffer and
+///        publishes it at VBlank, while the reader holds on to the front buffer. The third buffer holds the latest finished
+///        frame that hasn't been picked up yet, so neither side ever waits for the other, the reader never sees a frame mid
+///        render, and nothing is copied. Publishing is only safe from one thread, and acquiring and releasing from one other.
+class FrameBuffers
+{
+public:
+    /// @brief Create three blank frame buffers.
+    /// @param frameSize Size of each frame buffer in bytes.
+    explicit FrameBuffers(size_t frameSize);
+
+    /// @brief Get the buffer to render the next frame into. Only call from the rendering thread.
+    /// @return Pointer to the back buffer.
+    uint8_t* BackBuffer() { return buffers_[back_].data(); }
+
+    /// @brief Publish the back buffer as the latest finished frame. Only call from the rendering thread.
+    /// @return Pointer to the buffer to render the next frame into.
+    uint8_t* Publish();
+
+    /// @brief Take the latest finished frame for reading. Only call from the reading thread. Acquiring again before releasing
+    ///        returns the same frame.
+    /// @return Pointer to the front buffer, which stays untouched by the renderer until it's released and acquired again.
+    uint8_t const* Acquire();
+
+    /// @brief Finish reading the frame returned by Acquire. Only call from the reading thread.
+    void Release() { acquired_ = false; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH = 0x04;  // Set when the middle buffer holds a frame that hasn't been acquired yet
+
+    std::array<std::vector<uint8_t>, 3> buffers_;
+
+    // Index of the middle buffer, plus the FRESH flag. The buffers only ever change hands by swapping an index in here.
+    std::atomic<uint8_t> middle_;
+
+    uint8_t back_;  // Only used by the rendering thread
+    uint8_t front_;  // Only used by the reading thread
+    bool acquired_;  // Only used by the reading thread
+};
@@ -3,7 +3,9 @@
 #include <Cartridge/Cartridge.hpp>
 #include <APU.hpp>
 #include <CPU.hpp>
+#include <FrameBuffers.hpp>
 #include <PPU.hpp>
+#include <Scheduler.hpp>
 #include <array>
 #include <cstdint>
 #include <filesystem>
@@ -111,12 +113,19 @@ enum : uint8_t
 
 class GameBoy
 {
+    friend class CPU;
+    friend struct BenchmarkAccess;
+
 public:
     /// @brief GameBoy constructor. Handles creation of all components.
     GameBoy();
 
     void Initialize(uint8_t* frameBuffer);
 
+    /// @brief Render into triple-buffered frames instead of a single frame buffer.
+    /// @param frames Frame buffers to render into.
+    void Initialize(FrameBuffers* frames);
+
     /// @brief Load cartridge data from GameBoy ROM.
     /// @param[in] romPath Path to gb ROM file.
     /// @param[in] saveDirectory Directory to save and load cartridge SRAM from.
@@ -128,6 +137,9 @@ public:
     /// @param[in] bootRomPath Path to boot ROM.
     void PowerOn(std::filesystem::path bootRomPath);
 
+    /// @brief Eject the cartridge, flushing its SRAM to disk. PowerOn must be preceded by InsertCartridge to run again.
+    void PowerOff();
+
     /// @brief Run the Game Boy for some number of machine cycles. Return early if the frame buffer is ready to be displayed.
     /// @param[in] numCycles Number of machine cycles to run it for.
     /// @pre Initialize, InsertCartridge, and PowerOn must have been called.
@@ -136,15 +148,22 @@ public:
 
     bool FrameReady() { return ppu_.FrameReady(); }
 
-    /// @brief Set the sample rate used for audio playback. This is used to set parameters of the low pass filter.
-    /// @param sampleRate Sample rate to downsample to.
+    /// @brief Set the sample rate used for audio playback.
+    /// @param sampleRate Sample rate to render at.
     void SetSampleRate(int sampleRate) { apu_.SetSampleRate(sampleRate); }
 
-    /// @brief Apply low pass filters and downsampling to sample buffers and fill playback buffer.
+    /// @brief Render the audio produced since the last call at the playback rate and fill the playback buffer.
     /// @param buffer Pointer to buffer to fill.
     /// @param count Buffer size. Number of samples to provide is half of this due to stereo playback.
     void DrainSampleBuffer(float* buffer, int count) { apu_.DrainSampleBuffer(buffer, count); };
 
+    /// @brief Throw away pending audio output. Used when running without audio output.
+    void DiscardSamples() { apu_.DiscardSamples(); }
+
+    /// @brief Only check whether the APU's output changed once every few M-cycles.
+    /// @param factor Check one of every factor M-cycles. 1 checks every M-cycle (default), 0 produces no output at all.
+    void SetSampleDecimation(int factor) { apu_.SetSampleDecimation(factor); }
+
     /// @brief Update which buttons are currently being pressed.
     /// @param[in] down True if down is currently pressed.
     /// @param[in] up True if up is currently pressed.
@@ -163,6 +182,10 @@ public:
     void Serialize(std::ofstream& out);
     void Deserialize(std::ifstream& in);
 
+    /// @brief Write the contents of WRAM (all 8 banks) followed by HRAM.
+    /// @param[in] out Stream to write RAM contents to.
+    void DumpRam(std::ofstream& out);
+
     /// @brief Set whether a specific sound channel should be mixed in to the APU output.
     /// @param channel Channel number to set (1-4).
     /// @param enabled True to enable channel, false to disable it.
@@ -180,6 +203,14 @@ public:
     /// @param useDmgColors True if DMG colors should be used.
     void PreferDmgColors(bool useDmgColors) { ppu_.PreferDmgColors(useDmgColors); }
 
+    /// @brief Choose how pixels are written to the frame buffer.
+    /// @param format Format of each pixel.
+    void SetPixelFormat(PixelFormat format) { ppu_.SetPixelFormat(format); }
+
+    /// @brief Get the colors that PixelFormat::INDEXED8 pixels refer to.
+    /// @return 64 RGB555 colors.
+    std::array<uint16_t, 64> PaletteTable() const { return ppu_.PaletteTable(); }
+
     /// @brief Determine whether background, window, obp0, and obp1 should use the same palette or individual ones.
     /// @param individualPalettes True if each pixel type should use its own palette.
     void UseIndividualPalettes(bool individualPalettes) { ppu_.UseIndividualPalettes(individualPalettes); }
@@ -194,24 +225,118 @@ public:
     /// @param data Pointer to RGB data (12 0-255 values)
     void SetCustomPalette(uint8_t index, uint8_t* data) { ppu_.SetCustomPalette(index, data); }
 
+    /// @brief Choose whether the CPU may run whole instructions at once before catching the rest of the system up. Emulated
+    ///        behavior is identical either way, instruction stepping just avoids per M-cycle overhead where it's safe to do so.
+    /// @param enabled True to allow instruction stepping, false to always interleave components every M-cycle.
+    void SetInstructionStepping(bool enabled) { instructionStepping_ = enabled; }
+
+    /// @brief Choose whether the PPU draws each scanline in one go instead of running its pixel FIFO every dot. Lines where
+    ///        rendering registers change during mode 3 still use the pixel FIFO, so output and timing are unaffected.
+    /// @param enabled True to use the scanline renderer, false to always use the pixel FIFO (default).
+    void SetScanlineRenderer(bool enabled)
+    {
+        SyncPPU();
+        ppu_.SetScanlineRenderer(enabled);
+    }
+
+    /// @brief Only produce pixels for one of every few frames. Skipped frames keep exact PPU timing, so emulated behavior is
+    ///        unaffected, but leave the frame buffer untouched.
+    /// @param framesToSkip Number of frames to skip after each rendered frame. 0 renders every frame (default).
+    void SetFrameSkip(uint8_t framesToSkip)
+    {
+        SyncPPU();
+        ppu_.SetFrameSkip(framesToSkip);
+    }
+
+    /// @brief Check whether the last finished frame was rendered or skipped.
+    /// @return True if the frame buffer holds the last finished frame.
+    bool FrameRendered() const { return ppu_.FrameRendered(); }
+
 private:
     /// @brief Execute the specified number of machine cycles.
     /// @param numCycles Number of machine cycles to execute.
     std::pair<int, bool> RunMCycles(int numCycles);
 
+    /// @brief Run one machine cycle of every component.
+    /// @param cpuAlreadyClocked True if the CPU already ran this M-cycle ahead of the other components.
+    void ClockMCycle(bool cpuAlreadyClocked);
+
+    /// @brief Check whether the next CPU instruction can run ahead of the rest of the system. This is only allowed at normal
+    ///        speed when no DMA or speed switch is in progress, since those interact with the CPU on every M-cycle.
+    /// @return True if StepInstruction may be used.
+    bool CanStepInstruction() const;
+
+    /// @brief Run the CPU through a whole instruction, then clock the other components for the M-cycles it took. Any access
+    ///        the CPU makes outside of memory only it can observe first catches the other components up to that M-cycle.
+    /// @return Number of machine cycles the instruction took.
+    int StepInstruction();
+
+    /// @brief Clock the other components up to the M-cycle that the CPU is currently executing.
+    void CatchUpToCpu();
+
+    /// @brief While the CPU is halted and the PPU is idle, nothing can raise an interrupt until the next scheduled event. Skip
+    ///        straight to the M-cycle of that event, only running the APU for the M-cycles in between.
+    /// @param maxCycles Maximum number of machine cycles to skip.
+    /// @return Number of machine cycles skipped. 0 if the system can't be fast-forwarded right now.
+    int FastForwardHalt(int maxCycles);
+
     void ClockVariableSpeedComponents(bool clockCpu);
 
-    /// @brief Clock the timer components.
-    void ClockTimer();
+    /// @brief Bring TIMA and the timer's internal counter up to date with the variable speed clocks run so far.
+    void SyncTimer();
+
+    /// @brief Schedule the reload of TIMA that follows its next overflow, based on the current timer state.
+    /// @pre SyncTimer was just called.
+    void ScheduleTimerReload();
+
+    /// @brief Run the variable speed clock on which TIMA reloads from TMA and requests a timer interrupt.
+    void ReloadTimer();
+
+    /// @brief Bring DIV up to date with the variable speed clocks run so far. DIV doesn't count during a speed switch.
+    void SyncDivider();
+
+    /// @brief Schedule the next frame sequencer step from the current DIV value.
+    /// @pre SyncDivider was just called.
+    void ScheduleFrameSequencer();
+
+    /// @brief Run the variable speed clock on which DIV's APU bit falls and the frame sequencer advances.
+    void ClockFrameSequencer();
+
+    /// @brief Reset DIV, which also restarts the timer's internal counter.
+    void ResetDivider();
 
     /// @brief Run one cycle of an OAM DMA transfer.
     void ClockOamDma();
 
     void ClockVramDma();
 
-    /// @brief Run one cycle of a serial transfer.
+    /// @brief Shift out the next bit of a serial transfer and schedule the one after it.
     void ClockSerialTransfer();
 
+    /// @brief Run the PPU for one dot. While the PPU is idle it's left asleep until its wake event, or until something accesses
+    ///        it.
+    void ClockPPU();
+
+    /// @brief Bring a sleeping PPU up to the current dot so it can be accessed.
+    void SyncPPU();
+
+    /// @brief Skip the dots the PPU slept through and resume clocking it every dot.
+    void WakePPU();
+
+    /// @brief Get the dot on which a variable speed clock will run, assuming the speed mode doesn't change before then.
+    /// @param clock Index of the variable speed clock. Clocks at or before the current one map to the current dot.
+    /// @return Master clock dot of that variable speed clock.
+    uint64_t VariableSpeedClockDot(uint64_t clock) const;
+
+    /// @brief Schedule an event that is counted in variable speed clocks rather than dots.
+    /// @param event Event to schedule.
+    /// @param clock Index of the variable speed clock on which to handle the event.
+    void ScheduleVariableSpeedEvent(Event event, uint64_t clock);
+
+    /// @brief Handle every scheduled event that is due by the current dot and phase.
+    /// @param phase Point within the current dot being run.
+    void RunDueEvents(Phase phase);
+
     /// @brief Update JOYP with most recently pressed buttons when written.
     /// @param[in] data Data being written to JOYP.
     void UpdateJOYP(uint8_t data);
@@ -234,7 +359,12 @@ private:
 
     bool PrepareSpeedSwitch() const { return ioReg_[IO::KEY1] & 0x01; }
 
-    void SwitchSpeedMode() { ioReg_[IO::KEY1] ^= 0x80; }
+    /// @brief Toggle between normal and double speed mode, rescheduling events counted in variable speed clocks.
+    void SwitchSpeedMode();
+
+    /// @brief Get the number of dots between each clock of the variable speed components.
+    /// @return 4 in normal speed mode, 2 in double speed mode.
+    uint_fast8_t VariableSpeedDots() const { return DoubleSpeedMode() ? 2 : 4; }
 
     /// @brief Determine what happens when CPU executes a STOP instruction.
     /// @param IME Whether interrupts are currently enabled in the CPU.
@@ -254,6 +384,43 @@ private:
     /// @param data Byte to write to provided address.
     void Write(uint16_t addr, uint8_t data);
 
+    /// @brief Point the memory map at the boot ROM and the cartridge ROM and RAM banks that are currently mapped in. Must be
+    ///        called whenever the cartridge's bank registers or the boot ROM mapping may have changed.
+    void MapCartridgePages();
+
+    /// @brief Point part of the memory map for $0000-$7FFF at the boot ROM or the cartridge ROM banks currently mapped in.
+    /// @param firstPage First page (upper byte of address) to map.
+    /// @param endPage Page after the last one to map.
+    void MapRomPages(uint_fast16_t firstPage, uint_fast16_t endPage);
+
+    /// @brief Point the memory map for $A000-$BFFF at the cartridge RAM bank currently mapped in.
+    void MapRamPages();
+
+    /// @brief Point the memory map at the WRAM bank currently selected by SVBK. Must be called whenever SVBK or CGB mode
+    ///        changes.
+    void MapWramPages();
+
+    /// @brief Read on behalf of the CPU. If the CPU is running ahead and the address is visible to other components, catch
+    ///        them up first.
+    /// @param addr Address to read from.
+    /// @return Byte located at the provided address.
+    uint8_t CpuRead(uint16_t addr);
+
+    /// @brief Write on behalf of the CPU. If the CPU is running ahead and the address is visible to other components, catch
+    ///        them up first.
+    /// @param addr Address to write to.
+    /// @param data Byte to write to provided address.
+    void CpuWrite(uint16_t addr, uint8_t data);
+
+    /// @brief Determine whether an address is only ever accessed by the CPU, so that it may be accessed while the CPU is
+    ///        running ahead of the other components.
+    /// @param addr Address to check.
+    /// @return True if no other component can observe or modify the address.
+    bool CpuPrivateAddress(uint16_t addr) const;
+
+    /// @brief Check whether an OAM or VRAM DMA transfer is in progress.
+    bool DmaInProgress() const { return oamDmaInProgress_ || gdmaInProgress_ || hdmaInProgress_; }
+
     /// @brief Read a memory mapped I/O register.
     /// @param addr Address of register.
     /// @return Byte based on the register's read behavior.
@@ -280,6 +447,11 @@ private:
     std::array<uint8_t, 0x900> BOOT_ROM;  // Boot ROM
     uint8_t* frameBuffer_;
 
+    // Memory map. Each entry points to the host memory backing one 256 byte page of the address space, or is nullptr if
+    // accesses to that page have side effects and must be decoded by Read/Write.
+    std::array<uint8_t const*, 0x100> readPages_;
+    std::array<uint8_t*, 0x100> writePages_;
+
     // Joypad
     struct
     {
@@ -297,21 +469,28 @@ private:
     bool runningBootRom_;
     bool stopped_;
 
+    // Instruction stepping
+    static constexpr int MAX_INSTRUCTION_M_CYCLES = 6;
+    bool instructionStepping_;
+    int cpuCyclesAhead_;
+
     // Speed switch
     uint16_t speedSwitchCountdown_;
 
     // Serial transfer
     uint8_t serialOutData_;
     uint8_t serialBitsSent_;
-    uint8_t serialTransferCounter_;
     uint8_t serialClockDivider_;
     bool serialTransferInProgress_;
+    static constexpr uint64_t SERIAL_BIT_PERIOD = 128;  // Variable speed clocks per bit
 
     // Timer
     uint16_t timerCounter_;
     uint16_t timerControl_;
     bool timerEnabled_;
     bool timerReload_;
+    uint64_t timerSyncedClock_;    // Variable speed clocks that TIMA and timerCounter_ are up to date with
+    uint64_t dividerSyncedClock_;  // Variable speed clocks that DIV is up to date with
 
     // OAM DMA
     enum class OamDmaSrc
@@ -342,9 +521,27 @@ private:
     uint8_t lastPendingInterrupt_;
     bool prevStatState_;
 
+    // Scheduling
+    Scheduler scheduler_;
+    uint64_t masterClock_;  // Number of dots run since power on
+    bool ppuAwake_;
+    uint64_t ppuIdleStart_;  // First dot that a sleeping PPU has not been clocked for
+    uint64_t variableSpeedClocks_;  // Number of variable speed clocks completed since power on
+    std::array<uint64_t, static_cast<size_t>(Event::COUNT)> variableSpeedEventClock_;  // Clock each such event is due on
+
     // Components
     APU apu_;
     CPU cpu_;
     PPU ppu_;
     std::unique_ptr<Cartridge> cartridge_;
 };
+
+// CPU bus accessors. These live here rather than in CPU.hpp since they require the complete GameBoy type.
+
+inline uint8_t CPU::Read(uint16_t addr) { return bus_.CpuRead(addr); }
+
+inline void CPU::Write(uint16_t addr, uint8_t data) { bus_.CpuWrite(addr, data); }
+
+inline void CPU::AcknowledgeInterrupt() { bus_.AcknowledgeInterrupt(); }
+
+inline std::pair<bool, bool> CPU::ReportStop(bool IME) { return bus_.Stop(IME); }
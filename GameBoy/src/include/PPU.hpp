@@ -1,12 +1,12 @@
 #pragma once
 
+#include <FrameBuffers.hpp>
 #include <PixelFIFO.hpp>
 #include <array>
 #include <cstdint>
 #include <fstream>
 #include <memory>
 #include <queue>
-#include <vector>
 
 namespace IO
 {
@@ -33,14 +33,36 @@ enum : uint8_t
 };
 };
 
+/// @brief Layout of each pixel written to the frame buffer. Byte formats are in memory order, word formats are native-endian.
+enum class PixelFormat : uint8_t
+{
+    RGB888 = 0,  // 3 bytes: R, G, B
+    RGBA8888,    // 4 bytes: R, G, B, 0xFF
+    XRGB8888,    // 32-bit word: 0xFFRRGGBB
+    RGB565,      // 16-bit word: 5 bits of red (top), 6 of green, 5 of blue
+    RGB555,      // 16-bit word: 5 bits each of red (bottom), green, blue, as stored in CGB palette RAM
+    INDEXED8,    // 1 byte: DMG shade (0-3) in DMG mode, or palette table index in CGB mode. 0xFF is a blank pixel in CGB mode.
+};
+
 class PPU
 {
+    friend struct BenchmarkAccess;
+
 public:
     PPU(bool const& cgbMode);
     void PowerOn(bool skipBootRom);
 
     void Clock();
 
+    /// @brief Determine how many upcoming dots would do nothing but advance the dot counter. This covers the rest of mode 2
+    ///        before the OAM scan, and the rest of the scanline once in HBlank or VBlank.
+    /// @return Number of dots that can be skipped with SkipDots instead of calling Clock.
+    uint16_t IdleDots() const;
+
+    /// @brief Advance through dots previously reported as idle by IdleDots.
+    /// @param numDots Number of dots to skip. Must not exceed the last value returned by IdleDots.
+    void SkipDots(uint16_t numDots) { dot_ += numDots; }
+
     uint8_t Read(uint16_t addr) const;
     void Write(uint16_t addr, uint8_t data, bool oamDmaWrite = false);
 
@@ -49,21 +71,43 @@ public:
 
     uint8_t GetMode() const { return STAT_ & 0x03; }
 
-    void SetFrameBuffer(uint8_t* frameBuffer) { frameBuffer_ = frameBuffer; }
+    void SetFrameBuffer(uint8_t* frameBuffer) { frameBuffer_ = frameBuffer; frames_ = nullptr; }
+
+    /// @brief Render into a set of triple-buffered frames, publishing each one at VBlank, instead of a single frame buffer.
+    /// @param frames Frame buffers to render into.
+    void SetFrameBuffers(FrameBuffers* frames) { frames_ = frames; frameBuffer_ = frames->BackBuffer(); }
+
+    /// @brief Choose how pixels are written to the frame buffer. Takes effect from the next pixel, so a switch part way
+    ///        through a frame leaves that frame mixed.
+    /// @param format Format of each pixel.
+    void SetPixelFormat(PixelFormat format);
+
+    /// @brief Get the size of each pixel in the frame buffer.
+    /// @return Bytes per pixel for the current pixel format.
+    uint8_t BytesPerPixel() const { return bytesPerPixel_; }
+
+    /// @brief Get the colors that PixelFormat::INDEXED8 pixels refer to, as they are right now.
+    /// @return 64 RGB555 colors. In CGB mode, entries 0-31 are the 8 background palettes and entries 32-63 are the 8 sprite
+    ///         palettes, 4 colors each. In DMG mode, entries 0-3 are the background's shades from lightest to darkest.
+    std::array<uint16_t, 64> PaletteTable() const;
 
     // DMG color control
 
     /// @brief Force PPU to render pixels with DMG palettes when skipping boot ROM.
     /// @param useDmgColors True if DMG colors should be used.
-    void ForceDmgColors(bool useDmgColors) { forceDmgColors_ = useDmgColors; }
+    void ForceDmgColors(bool useDmgColors) { forceDmgColors_ = useDmgColors; colorCacheDirty_ = true; }
 
     /// @brief Use custom DMG palettes when playing GB games. Toggle through GUI.
     /// @param useDmgColors True if DMG colors should be used.
-    void PreferDmgColors(bool useDmgColors) { preferDmgColors_ = useDmgColors; }
+    void PreferDmgColors(bool useDmgColors) { preferDmgColors_ = useDmgColors; colorCacheDirty_ = true; }
 
     /// @brief Determine whether background, window, obp0, and obp1 should use the same palette or individual ones.
     /// @param individualPalettes True if each pixel type should use its own palette.
-    void UseIndividualPalettes(bool individualPalettes) { useIndividualPalettes_ = individualPalettes; }
+    void UseIndividualPalettes(bool individualPalettes)
+    {
+        useIndividualPalettes_ = individualPalettes;
+        colorCacheDirty_ = true;
+    }
 
     /// @brief Specify colors in one of the custom DMG palettes.
     /// @param index Index of palette to update.
@@ -75,6 +119,25 @@ public:
     /// @param data Pointer to RGB data (12 0-255 values)
     void SetCustomPalette(uint8_t index, uint8_t* data);
 
+    /// @brief Notify the PPU that CGB mode was switched on or off, which changes how every pixel is colored.
+    void CgbModeChanged() { colorCacheDirty_ = true; }
+
+    /// @brief Choose how pixels are produced during mode 3. The scanline renderer draws each line in one go when mode 3 ends,
+    ///        and only runs the pixel FIFO for lines where a rendering register is written part way through mode 3. Mode 3 lasts
+    ///        the same number of dots either way.
+    /// @param enabled True to use the scanline renderer, false to run the pixel FIFO every dot.
+    void SetScanlineRenderer(bool enabled);
+
+    /// @brief Only produce pixels for one of every few frames. Skipped frames run with the same timing, interrupts, and mode 3
+    ///        lengths as rendered ones, but no pixel colors are worked out or written and the frame isn't published. Takes
+    ///        effect from the next frame.
+    /// @param framesToSkip Number of frames to skip after each rendered frame. 0 renders every frame.
+    void SetFrameSkip(uint8_t framesToSkip);
+
+    /// @brief Check whether the last finished frame was rendered or skipped.
+    /// @return True if the frame's pixels were produced.
+    bool FrameRendered() const { return frameRendered_; }
+
     // Register access
     bool LCDEnabled() const { return LCDC_ & 0x80; }
     uint8_t STAT() const { return STAT_; }
@@ -138,21 +201,95 @@ private:
     }
 
     // GUI overrides
+    typedef std::array<std::array<uint8_t, 3>, 4> PaletteArray;
+
+    static constexpr PaletteArray DEFAULT_DMG_PALETTE = {{{175, 203, 70},
+                                                          {121, 170, 109},
+                                                          {34, 111, 95},
+                                                          {8, 41, 85}}};
+
     bool preferDmgColors_;
     bool useIndividualPalettes_;
+    PaletteArray dmgPalette_;
+    PaletteArray bgPalette_;
+    PaletteArray winPalette_;
+    PaletteArray obp0Palette_;
+    PaletteArray obp1Palette_;
+
+    // Color cache. Every pixel's output depends only on its source, palette, and color index, so the colors for all 128
+    // combinations are worked out in the current pixel format whenever a palette, color, or format setting changes instead of
+    // for every pixel.
+    static size_t ColorCacheIndex(Pixel pixel)
+    {
+        return (static_cast<size_t>(pixel.src) << 5) | (pixel.palette << 2) | pixel.color;
+    }
+
+    void RebuildColorCache();
+    std::array<uint8_t, 3> PixelColor(Pixel pixel) const;
+    std::array<uint8_t, 3> DmgPixelColor(Pixel pixel) const;
+    uint8_t PixelIndex(Pixel pixel) const;
+    uint32_t EncodeColor(std::array<uint8_t, 3> rgb) const;
+
+    std::array<uint32_t, 128> colorCache_;
+    uint32_t blankColor_;  // Color of pixels drawn while the LCD is off
+    bool colorCacheDirty_;
+    PixelFormat pixelFormat_;
+    uint8_t bytesPerPixel_;
 
     // Disabled state
     void DisabledClock();
 
     // Rendering
     void RenderPixel(Pixel pixel);
-    void RenderDmgPixel(Pixel pixel);
+
+    /// @brief Write one pixel to the frame buffer as a single store of the current format's size.
+    /// @param color Pixel encoded in the current pixel format.
+    void WritePixel(uint32_t color);
+
+    /// @brief Finish the current frame at VBlank, handing it off if rendering into triple-buffered frames.
+    void PublishFrame();
     void OamScan();
 
+    /// @brief Check whether the window was drawn on the current scanline.
+    bool WindowVisible() const { return scanlineWindowVisible_ || pixelFifoPtr_->WindowVisible(); }
+
+    // Scanline renderer
+    struct TileRow
+    {
+        uint8_t low;  // Low bits of each pixel, leftmost pixel in bit 7
+        uint8_t high;  // High bits of each pixel, leftmost pixel in bit 7
+        uint8_t palette;
+        bool priority;
+    };
+
+    /// @brief Prepare to render the current line in one go. Work out when the pixel FIFO would finish mode 3 with the current
+    ///        register values so that the PPU can sleep until then.
+    void BeginScanline();
+
+    /// @brief Draw the whole current line, producing exactly the pixels the pixel FIFO would have.
+    void RenderScanline();
+
+    /// @brief Stop deferring the current line and run the pixel FIFO through the mode 3 dots it has missed so far, so that it
+    ///        can take over for the rest of the line.
+    void ResumePixelFifo();
+
+    /// @brief Fetch one row of a background or window tile.
+    /// @param mapAddr Address of the tile in a tile map.
+    /// @param row Row of the tile to fetch, before any vertical flip.
+    /// @return Tile data with any horizontal flip already applied.
+    TileRow FetchBackgroundTileRow(uint16_t mapAddr, uint8_t row) const;
+
+    /// @brief Add a sprite's pixels to the line's sprite pixels the same way PixelFIFO::PushSpritePixels does.
+    /// @param sprite Sprite to add.
+    /// @param spritePixels Sprite pixels for the line, indexed by LX.
+    /// @param spriteEnd One past the last LX with a sprite pixel queued.
+    void PushScanlineSprite(LineSprite const& sprite, std::array<Pixel, 168>& spritePixels, uint16_t& spriteEnd) const;
+
     // Data from bus
     bool const& cgbMode_;
     uint8_t* frameBuffer_;
     uint32_t framePointer_;
+    FrameBuffers* frames_;  // Frames to publish frameBuffer_ to at VBlank, if any
 
     // State
     uint16_t dot_;
@@ -168,6 +305,25 @@ private:
     uint8_t disabledY_;
     bool firstEnabledFrame_;
 
+    // Scanline renderer
+    static constexpr uint8_t NO_WINDOW = 0xFF;
+    bool scanlineRenderer_;
+    bool scanlineDeferred_;  // Current line will be drawn by RenderScanline when mode 3 ends
+    bool scanlineWindowVisible_;
+    uint16_t mode3EndDot_;  // Dot on which a deferred line enters mode 0
+    uint8_t windowStartX_;  // LX of the first window pixel on a deferred line, or NO_WINDOW
+    uint8_t windowStartColumn_;  // Window column of the pixel at windowStartX_
+
+    // Frame skip
+    uint8_t frameSkip_;  // Frames to skip after each rendered frame
+    uint8_t frameSkipCounter_;  // Position of the current frame in the cycle of one rendered frame and frameSkip_ skipped ones
+    bool skipFrame_;  // Current frame produces no pixels
+    bool frameRendered_;  // Last finished frame produced pixels
+
+    // OAM scan
+    std::array<OamEntry, MAX_SPRITES_PER_LINE> lineSprites_;  // Sprites found by the last OAM scan
+    uint8_t numLineSprites_;
+
     // FIFO
     friend class PixelFIFO;
     std::unique_ptr<PixelFIFO> pixelFifoPtr_;
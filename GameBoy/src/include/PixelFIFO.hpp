@@ -1,14 +1,14 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <optional>
-#include <utility>
-#include <vector>
 
 class PPU;
 
+static constexpr size_t MAX_SPRITES_PER_LINE = 10;
+
 struct OamEntry
 {
     uint8_t yPos;
@@ -26,7 +26,7 @@ struct OamEntry
     } flags;
 };
 
-enum class PixelSource
+enum class PixelSource : uint8_t
 {
     BLANK = 0,
     BACKGROUND,
@@ -34,13 +34,65 @@ enum class PixelSource
     WINDOW,
 };
 
+/// @brief Pixel waiting in a FIFO, packed into 16 bits.
 struct Pixel
 {
-    uint8_t color;
-    uint8_t palette;
-    uint8_t spritePriority;
-    bool priority;
-    PixelSource src;
+    Pixel() = default;
+
+    Pixel(uint8_t color, uint8_t palette, uint8_t spritePriority, bool priority, PixelSource src) :
+        color(color), palette(palette), spritePriority(spritePriority), priority(priority), src(src)
+    {
+    }
+
+    uint16_t color : 2;
+    uint16_t palette : 3;
+    uint16_t spritePriority : 4;
+    uint16_t priority : 1;
+    PixelSource src : 2;
+};
+
+/// @brief Sprite found by the OAM scan that will be fetched during mode 3.
+struct LineSprite
+{
+    OamEntry entry;
+    uint8_t index;  // Position among the line's sprites, used for CGB sprite priority
+    uint8_t leftEdge;  // LX at which the sprite is fetched
+};
+
+/// @brief Fixed-capacity FIFO queue that never allocates.
+/// @tparam T Type of item in the queue.
+/// @tparam CAPACITY Maximum number of items. Must be a power of two.
+template <typename T, size_t CAPACITY>
+class RingBuffer
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+public:
+    void Clear() { head_ = 0; size_ = 0; }
+    bool Empty() const { return size_ == 0; }
+    size_t Size() const { return size_; }
+
+    /// @brief Add an item to the back of the queue. The queue must not be full.
+    void PushBack(T item) { buffer_[(head_ + size_) & MASK] = item; ++size_; }
+
+    /// @brief Remove the item at the front of the queue. The queue must not be empty.
+    /// @return Item that was at the front.
+    T PopFront()
+    {
+        T item = buffer_[head_];
+        head_ = (head_ + 1) & MASK;
+        --size_;
+        return item;
+    }
+
+    /// @brief Access an item by its position from the front of the queue.
+    T& operator[](size_t index) { return buffer_[(head_ + index) & MASK]; }
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+    std::array<T, CAPACITY> buffer_;
+    uint8_t head_ = 0;
+    uint8_t size_ = 0;
 };
 
 class PixelFIFO
@@ -51,10 +103,22 @@ public:
     void Reset();
 
     std::optional<Pixel> Clock();
-    void LoadSprites(std::vector<OamEntry> const& sprites);
+    void LoadSprites(std::array<OamEntry, MAX_SPRITES_PER_LINE> const& sprites, uint8_t numSprites);
 
     bool WindowVisible() const;
 
+    /// @brief Get the sprites loaded for the current line, ordered by the LX they're fetched at and then by OAM order.
+    std::array<LineSprite, MAX_SPRITES_PER_LINE> const& Sprites() const { return sprites_; }
+
+    /// @brief Get the number of sprites loaded for the current line.
+    uint8_t NumSprites() const { return numSprites_; }
+
+    /// @brief Choose which of a background/window pixel and a sprite pixel ends up on screen.
+    /// @param bgPixel Pixel from the background FIFO.
+    /// @param spritePixel Pixel from the sprite FIFO, or an empty pixel if there wasn't one.
+    /// @return Pixel to render.
+    Pixel MixPixels(Pixel bgPixel, Pixel spritePixel) const;
+
 private:
     bool SwitchToWindow() const;
 
@@ -87,11 +151,13 @@ private:
     uint8_t pixelsToScroll_;
 
     // Bg/Window data
-    std::deque<Pixel> backgroundFIFO_;
+    RingBuffer<Pixel, 16> backgroundFIFO_;
 
     // Sprite data
-    std::deque<Pixel> spriteFIFO_;
-    std::array<std::deque<std::pair<OamEntry, uint8_t>>, 160> orderedSprites_;
+    RingBuffer<Pixel, 16> spriteFIFO_;
+    std::array<LineSprite, MAX_SPRITES_PER_LINE> sprites_;
+    uint8_t numSprites_;
+    uint8_t nextSprite_;  // Next sprite in sprites_ to be fetched
 
     // Pixel fetcher
     struct Fetcher
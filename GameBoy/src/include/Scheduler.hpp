@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/// @brief Events that components can schedule instead of being polled every cycle. Each event can be pending at most once.
+enum class Event : uint8_t
+{
+    PPU_WAKE,         // PPU has finished an idle stretch (rest of mode 2 before OAM scan, HBlank, VBlank) and must be clocked again
+    SERIAL_BIT,       // Serial transfer shifts out its next bit
+    TIMER_RELOAD,     // TIMA reloads from TMA and requests an interrupt, one clock after overflowing
+    FRAME_SEQUENCER,  // DIV's APU bit falls and the APU frame sequencer advances
+
+    COUNT
+};
+
+/// @brief Point within a dot at which an event is handled. Variable speed components (CPU, serial, OAM DMA, timer) are clocked
+///        before the PPU within the same dot.
+enum class Phase : uint8_t
+{
+    VARIABLE_SPEED = 0,
+    PPU = 1,
+};
+
+class Scheduler
+{
+public:
+    /// @brief Create an empty scheduler.
+    Scheduler() { Reset(); }
+
+    /// @brief Remove all pending events.
+    void Reset();
+
+    /// @brief Schedule an event. If the event is already pending, it's moved to the new time.
+    /// @param event Event to schedule.
+    /// @param dot Master clock dot at which the event should be handled.
+    /// @param phase Point within that dot at which the event should be handled.
+    void Schedule(Event event, uint64_t dot, Phase phase);
+
+    /// @brief Remove an event if it's pending.
+    /// @param event Event to cancel.
+    void Cancel(Event event);
+
+    /// @brief Check whether an event is currently scheduled.
+    /// @param event Event to check.
+    /// @return True if the event is pending.
+    bool Pending(Event event) const { return position_[static_cast<uint8_t>(event)] != NOT_SCHEDULED; }
+
+    /// @brief Get the dot that a pending event is scheduled for.
+    /// @param event Event to check. Must be pending.
+    /// @return Master clock dot the event will be handled on.
+    uint64_t ScheduledDot(Event event) const { return heap_[position_[static_cast<uint8_t>(event)]].key >> 1; }
+
+    /// @brief Check whether the earliest pending event should be handled by now.
+    /// @param dot Current master clock dot.
+    /// @param phase Current point within that dot.
+    /// @return True if PopDueEvent will return an event.
+    bool EventDue(uint64_t dot, Phase phase) const { return (size_ != 0) && (heap_[0].key <= Key(dot, phase)); }
+
+    /// @brief Get the dot of the earliest pending event.
+    /// @pre At least one event is pending.
+    /// @return Master clock dot the earliest event will be handled on.
+    uint64_t NextDot() const { return heap_[0].key >> 1; }
+
+    /// @brief Remove the earliest pending event from the scheduler.
+    /// @pre EventDue returned true.
+    /// @return The event that should be handled now.
+    Event PopDueEvent();
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        Event event;
+    };
+
+    static constexpr uint8_t NOT_SCHEDULED = std::numeric_limits<uint8_t>::max();
+    static constexpr uint8_t CAPACITY = static_cast<uint8_t>(Event::COUNT);
+
+    /// @brief Combine a dot and phase into a single ordering key.
+    static uint64_t Key(uint64_t dot, Phase phase) { return (dot << 1) | static_cast<uint64_t>(phase); }
+
+    /// @brief Remove the entry at a position in the heap and restore the heap property.
+    /// @param index Position in the heap to remove.
+    void RemoveAt(uint8_t index);
+
+    /// @brief Move an entry towards the root of the heap until its parent is no later than it.
+    /// @param index Position in the heap of the entry to move.
+    void SiftUp(uint8_t index);
+
+    /// @brief Move an entry towards the leaves of the heap until its children are no earlier than it.
+    /// @param index Position in the heap of the entry to move.
+    void SiftDown(uint8_t index);
+
+    /// @brief Place an entry at a position in the heap and record where its event now lives.
+    void Place(uint8_t index, Entry entry);
+
+    // Binary min-heap ordered by key, and the position of each event within it.
+    std::array<Entry, CAPACITY> heap_;
+    std::array<uint8_t, CAPACITY> position_;
+    uint8_t size_;
+};
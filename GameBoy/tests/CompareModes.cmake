@@ -0,0 +1,68 @@
+# Run gbc-headless on a ROM in each emulation mode and check that every mode draws the same frames and runs the same number of
+# M-cycles as the default pixel FIFO with instruction stepping. With frame skipping, the frames that are drawn must match.
+#
+# Usage: cmake -DHEADLESS=<gbc-headless> -DROM=<rom> -DWORK_DIR=<dir> -P CompareModes.cmake
+
+set(FRAMES 300)
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# Run gbc-headless with extra options. Sets <name>_cycles to the M-cycles run and <name>_hashes to the lines of the hash log.
+function(run_headless name)
+    execute_process(
+        COMMAND ${HEADLESS} ${ROM} --frames ${FRAMES} --hash-log ${WORK_DIR}/${name}.txt ${ARGN}
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+        RESULT_VARIABLE result)
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "gbc-headless ${ARGN} failed:\n${output}")
+    endif()
+
+    string(REGEX MATCH "M-cycles: *([0-9]+)" cycles "${output}")
+    file(STRINGS ${WORK_DIR}/${name}.txt hashes)
+    set(${name}_cycles ${CMAKE_MATCH_1} PARENT_SCOPE)
+    set(${name}_hashes "${hashes}" PARENT_SCOPE)
+endfunction()
+
+run_headless(fifo)
+run_headless(scanline --scanline)
+run_headless(no_stepping --no-stepping)
+run_headless(frame_skip --frame-skip 2)
+
+# A ROM that draws the same thing every frame couldn't tell the modes apart.
+set(distinct_hashes ${fifo_hashes})
+list(TRANSFORM distinct_hashes REPLACE "^[0-9]+ " "")
+list(REMOVE_DUPLICATES distinct_hashes)
+list(LENGTH distinct_hashes num_distinct)
+
+if(num_distinct LESS 100)
+    message(FATAL_ERROR "Only ${num_distinct} distinct frames in ${FRAMES}")
+endif()
+
+foreach(mode scanline no_stepping frame_skip)
+    if(NOT ${mode}_cycles EQUAL fifo_cycles)
+        message(FATAL_ERROR "${mode} ran ${${mode}_cycles} M-cycles, pixel FIFO ran ${fifo_cycles}")
+    endif()
+endforeach()
+
+foreach(mode scanline no_stepping)
+    if(NOT "${${mode}_hashes}" STREQUAL "${fifo_hashes}")
+        message(FATAL_ERROR "${mode} drew different frames than the pixel FIFO, see ${WORK_DIR}")
+    endif()
+endforeach()
+
+# Skipping 2 frames draws frames 1, 4, 7, ... Each hash log line holds the frame number, so a drawn frame must appear as is.
+math(EXPR expected_drawn "(${FRAMES} + 2) / 3")
+list(LENGTH frame_skip_hashes num_drawn)
+
+if(NOT num_drawn EQUAL expected_drawn)
+    message(FATAL_ERROR "frame_skip drew ${num_drawn} frames, expected ${expected_drawn}")
+endif()
+
+foreach(line IN LISTS frame_skip_hashes)
+    list(FIND fifo_hashes "${line}" index)
+
+    if(index EQUAL -1)
+        message(FATAL_ERROR "frame_skip drew a different frame than the pixel FIFO: ${line}, see ${WORK_DIR}")
+    endif()
+endforeach()
@@ -0,0 +1,229 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <vector>
+
+static constexpr size_t ROM_SIZE = 0x8000;
+static constexpr uint16_t ENTRY_POINT = 0x0100;
+static constexpr uint16_t PROGRAM_START = 0x0150;
+static constexpr uint16_t VBLANK_VECTOR = 0x0040;
+static constexpr uint16_t STAT_VECTOR = 0x0048;
+static constexpr uint16_t VBLANK_HANDLER = 0x0200;
+static constexpr uint16_t STAT_HANDLER = 0x0220;
+
+/// @brief Writes machine code into a ROM image, keeping track of the address of the next byte.
+class Assembler
+{
+public:
+    Assembler(std::vector<uint8_t>& rom, uint16_t addr) : rom_(rom), addr_(addr) {}
+
+    /// @brief Get the address the next byte will be written to.
+    uint16_t Here() const { return addr_; }
+
+    /// @brief Write bytes of machine code.
+    void Emit(std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t const byte : bytes)
+        {
+            rom_[addr_++] = byte;
+        }
+    }
+
+    /// @brief Write an absolute jump.
+    void Jump(uint16_t target) { Emit({0xC3, static_cast<uint8_t>(target & 0xFF), static_cast<uint8_t>(target >> 8)}); }
+
+    /// @brief Write a relative jump, which must stay within 128 bytes of the address after it.
+    /// @param opcode JR opcode to use, e.g. 0x18 for JR or 0x20 for JR NZ.
+    /// @param target Address to jump to.
+    void JumpRelative(uint8_t opcode, uint16_t target)
+    {
+        Emit({opcode, static_cast<uint8_t>(target - (addr_ + 2))});
+    }
+
+private:
+    std::vector<uint8_t>& rom_;
+    uint16_t addr_;
+};
+
+/// @brief Program that turns on the LCD, then executes an illegal opcode, which locks up the CPU for good.
+static void WriteIllegalOpcodeProgram(std::vector<uint8_t>& rom)
+{
+    Assembler code(rom, PROGRAM_START);
+    code.Emit({0x3E, 0x91});  // LD A, $91
+    code.Emit({0xE0, 0x40});  // LDH (LCDC), A
+    code.Emit({0xD3});        // Illegal
+}
+
+/// @brief Program whose HBlank interrupt changes the scroll and DMG palettes every line, over a background, window, and 40
+///        sprites, so that each line's mode 3 length depends on the scroll, window, and sprite positions. The values written
+///        also depend on how long mode 3 took on every line so far. A VBlank interrupt moves the effect along every frame.
+static void WriteScanlineEffectsProgram(std::vector<uint8_t>& rom)
+{
+    Assembler code(rom, PROGRAM_START);
+    code.Emit({0xF3});              // DI
+    code.Emit({0x31, 0xFE, 0xFF});  // LD SP, $FFFE
+
+    // Wait for VBlank, then turn off the LCD so VRAM, OAM, and the palettes can be written freely.
+    uint16_t const waitVBlank = code.Here();
+    code.Emit({0xF0, 0x44});  // LDH A, (LY)
+    code.Emit({0xFE, 0x90});  // CP 144
+    code.JumpRelative(0x20, waitVBlank);
+    code.Emit({0xAF});        // XOR A
+    code.Emit({0xE0, 0x40});  // LDH (LCDC), A
+    code.Emit({0xE0, 0x80});  // LDH ($FF80), A: frame counter
+    code.Emit({0xE0, 0x81});  // LDH ($FF81), A: total of the HBlank loop counts
+
+    // Tile data at $8000-$97FF
+    code.Emit({0x21, 0x00, 0x80});  // LD HL, $8000
+    uint16_t const fillTiles = code.Here();
+    code.Emit({0x7D, 0x0F, 0xAC});  // LD A, L; RRCA; XOR H
+    code.Emit({0x22});              // LD (HL+), A
+    code.Emit({0x7C, 0xFE, 0x98});  // LD A, H; CP $98
+    code.JumpRelative(0x20, fillTiles);
+
+    // Tile maps at $9800-$9FFF
+    uint16_t const fillMaps = code.Here();
+    code.Emit({0x7D, 0x22});        // LD A, L; LD (HL+), A
+    code.Emit({0x7C, 0xFE, 0xA0});  // LD A, H; CP $A0
+    code.JumpRelative(0x20, fillMaps);
+
+    // OAM: 40 sprites spread over the screen with a mix of attributes
+    code.Emit({0x21, 0x00, 0xFE});  // LD HL, $FE00
+    uint16_t const fillOam = code.Here();
+    code.Emit({0x7D, 0xEE, 0x5A});  // LD A, L; XOR $5A
+    code.Emit({0xE6, 0x7F});        // AND $7F
+    code.Emit({0xC6, 0x10});        // ADD A, $10
+    code.Emit({0x22});              // LD (HL+), A
+    code.Emit({0x7D, 0xFE, 0xA0});  // LD A, L; CP $A0
+    code.JumpRelative(0x20, fillOam);
+
+    // CGB palettes. DMG mode ignores these writes.
+    code.Emit({0x3E, 0x80});  // LD A, $80
+    code.Emit({0xE0, 0x68});  // LDH (BCPS), A
+    code.Emit({0xE0, 0x6A});  // LDH (OCPS), A
+    code.Emit({0x06, 0x40});  // LD B, $40
+    uint16_t const fillPalettes = code.Here();
+    code.Emit({0x78, 0x07, 0x07, 0xA8});  // LD A, B; RLCA; RLCA; XOR B
+    code.Emit({0xE0, 0x69});              // LDH (BCPD), A
+    code.Emit({0x2F});                    // CPL
+    code.Emit({0xE0, 0x6B});              // LDH (OCPD), A
+    code.Emit({0x05});                    // DEC B
+    code.JumpRelative(0x20, fillPalettes);
+
+    code.Emit({0x3E, 0x50, 0xE0, 0x4A});  // LD A, 80; LDH (WY), A
+    code.Emit({0x3E, 0x58, 0xE0, 0x4B});  // LD A, 88; LDH (WX), A
+    code.Emit({0x3E, 0x08, 0xE0, 0x41});  // LD A, $08; LDH (STAT), A: HBlank interrupt
+    code.Emit({0x3E, 0x03, 0xE0, 0xFF});  // LD A, $03; LDH (IE), A: VBlank and STAT
+    code.Emit({0xAF, 0xE0, 0x0F});        // XOR A; LDH (IF), A
+    code.Emit({0x3E, 0xB3, 0xE0, 0x40});  // LD A, $B3; LDH (LCDC), A: LCD, window, sprites, and background on
+    code.Emit({0xFB});                    // EI
+
+    uint16_t const idle = code.Here();
+    code.Emit({0x76});  // HALT
+    code.JumpRelative(0x18, idle);
+
+    Assembler vBlankVector(rom, VBLANK_VECTOR);
+    vBlankVector.Jump(VBLANK_HANDLER);
+    Assembler statVector(rom, STAT_VECTOR);
+    statVector.Jump(STAT_HANDLER);
+
+    // Count frames.
+    Assembler vBlank(rom, VBLANK_HANDLER);
+    vBlank.Emit({0xF5});        // PUSH AF
+    vBlank.Emit({0xF0, 0x80});  // LDH A, ($FF80)
+    vBlank.Emit({0x3C});        // INC A
+    vBlank.Emit({0xE0, 0x80});  // LDH ($FF80), A
+    vBlank.Emit({0xF1, 0xD9});  // POP AF; RETI
+
+    // Measure how much of HBlank is left by counting loops until LY changes, which depends on how long mode 3 took. Set SCX for
+    // the new line from LY and the frame count. Add the loop count to a running total, which sets SCY and the DMG palettes, so
+    // that mode 3's length shows up in the frame, and any difference in it, even in a skipped frame, carries over into every
+    // later frame.
+    Assembler stat(rom, STAT_HANDLER);
+    stat.Emit({0xF5, 0xC5});  // PUSH AF; PUSH BC
+    stat.Emit({0xF0, 0x44});  // LDH A, (LY)
+    stat.Emit({0x47});        // LD B, A
+
+    // Return straight away on the last visible line, so that VBlank always starts with the CPU halted. Every mode reports the
+    // end of the frame on the same M-cycle then. Otherwise instruction stepping can report it up to one instruction late.
+    stat.Emit({0xFE, 0x8F});                    // CP 143
+    stat.JumpRelative(0x20, stat.Here() + 5);  // JR NZ, past the return
+    stat.Emit({0xC1, 0xF1, 0xD9});              // POP BC; POP AF; RETI
+
+    stat.Emit({0x0E, 0x00});  // LD C, 0
+    uint16_t const waitLine = stat.Here();
+    stat.Emit({0x0C});        // INC C
+    stat.Emit({0xF0, 0x44});  // LDH A, (LY)
+    stat.Emit({0xB8});        // CP B
+    stat.JumpRelative(0x28, waitLine);
+    stat.Emit({0xF0, 0x80});  // LDH A, ($FF80)
+    stat.Emit({0x80});        // ADD A, B
+    stat.Emit({0xE0, 0x43});  // LDH (SCX), A
+    stat.Emit({0xF0, 0x81});  // LDH A, ($FF81)
+    stat.Emit({0x81});        // ADD A, C
+    stat.Emit({0xE0, 0x81});  // LDH ($FF81), A
+    stat.Emit({0xE0, 0x42});  // LDH (SCY), A
+    stat.Emit({0xE0, 0x47});  // LDH (BGP), A
+    stat.Emit({0x2F});        // CPL
+    stat.Emit({0xE0, 0x48});  // LDH (OBP0), A
+    stat.Emit({0xC1, 0xF1});  // POP BC; POP AF
+    stat.Emit({0xD9});        // RETI
+}
+
+/// @brief Write a 32 KiB ROM only cartridge for one of the regression checks.
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::printf("Usage: %s <illegal-opcode|scanline-effects|scanline-effects-cgb> <output rom>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> rom(ROM_SIZE, 0x00);
+    char const* title = argv[1];
+
+    if (std::strcmp(argv[1], "illegal-opcode") == 0)
+    {
+        WriteIllegalOpcodeProgram(rom);
+    }
+    else if (std::strcmp(argv[1], "scanline-effects") == 0)
+    {
+        WriteScanlineEffectsProgram(rom);
+    }
+    else if (std::strcmp(argv[1], "scanline-effects-cgb") == 0)
+    {
+        WriteScanlineEffectsProgram(rom);
+        rom[0x0143] = 0x80;  // CGB enhanced
+    }
+    else
+    {
+        std::fprintf(stderr, "Unknown ROM: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // NOP; JP PROGRAM_START
+    Assembler entry(rom, ENTRY_POINT);
+    entry.Emit({0x00});
+    entry.Jump(PROGRAM_START);
+
+    for (size_t i = 0; (i < std::strlen(title)) && (i < 15); ++i)
+    {
+        rom[0x0134 + i] = title[i];
+    }
+
+    uint8_t checksum = 0;
+
+    for (uint16_t addr = 0x0134; addr <= 0x014C; ++addr)
+    {
+        checksum = checksum - rom[addr] - 1;
+    }
+
+    rom[0x014D] = checksum;
+
+    std::ofstream out(argv[2], std::ios::binary);
+    out.write(reinterpret_cast<char const*>(rom.data()), rom.size());
+    return out.fail() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include <GBC.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr int WIDTH = 160;
+static constexpr int HEIGHT = 144;
+static constexpr size_t FRAME_BUFFER_SIZE = WIDTH * HEIGHT * 3;
+static constexpr double CPU_CLOCK_FREQUENCY = 1048576.0;
+
+/// @brief Command line options.
+struct Options
+{
+    std::filesystem::path romPath;
+    std::filesystem::path bootRomPath;
+    std::filesystem::path saveStatePath;
+    std::filesystem::path framePath;    // Write final frame as a PPM image
+    std::filesystem::path hashLogPath;  // Write frame number and hash of every frame
+    uint64_t frames = 0;
+    uint64_t cycles = 0;
+    int frameSkip = 0;
+    bool scanlineRenderer = false;
+    bool instructionStepping = true;
+};
+
+static void PrintUsage(char const* program)
+{
+    std::printf("Usage: %s <rom> [options]\n"
+                "\n"
+                "Run a game as fast as possible without audio or video output and report emulation speed.\n"
+                "\n"
+                "Options:\n"
+                "  --frames N         Run for N frames (default 3600 if --cycles isn't given)\n"
+                "  --cycles N         Run for N machine cycles\n"
+                "  --boot-rom PATH    Run boot ROM before the game\n"
+                "  --state PATH       Load a save state before running\n"
+                "  --scanline         Use the scanline renderer when possible instead of always using the pixel FIFO\n"
+                "  --frame-skip N     Skip drawing N frames after each drawn frame\n"
+                "  --no-stepping      Clock the CPU one M-cycle at a time instead of running whole instructions ahead\n"
+                "  --dump-frame PATH  Write the final frame to PATH as a PPM image\n"
+                "  --hash-log PATH    Write the frame number and FNV-1a hash of every drawn frame to PATH\n",
+                program);
+}
+
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1) < argc;
+
+        if ((arg == "-h") || (arg == "--help"))
+        {
+            return false;
+        }
+        else if (arg == "--scanline")
+        {
+            options.scanlineRenderer = true;
+        }
+        else if (arg == "--no-stepping")
+        {
+            options.instructionStepping = false;
+        }
+        else if (!arg.empty() && (arg[0] != '-'))
+        {
+            if (!options.romPath.empty())
+            {
+                return false;
+            }
+
+            options.romPath = arg;
+        }
+        else if (!hasValue)
+        {
+            return false;
+        }
+        else if (arg == "--frames")
+        {
+            options.frames = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--frame-skip")
+        {
+            options.frameSkip = std::clamp(std::atoi(argv[++i]), 0, 0xFF);
+        }
+        else if (arg == "--cycles")
+        {
+            options.cycles = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--boot-rom")
+        {
+            options.bootRomPath = argv[++i];
+        }
+        else if (arg == "--state")
+        {
+            options.saveStatePath = argv[++i];
+        }
+        else if (arg == "--dump-frame")
+        {
+            options.framePath = argv[++i];
+        }
+        else if (arg == "--hash-log")
+        {
+            options.hashLogPath = argv[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if ((options.frames == 0) && (options.cycles == 0))
+    {
+        options.frames = 3600;
+    }
+
+    return !options.romPath.empty();
+}
+
+static bool WriteFrame(std::filesystem::path const& framePath, std::vector<uint8_t> const& frameBuffer)
+{
+    std::ofstream out(framePath, std::ios::binary);
+
+    if (out.fail())
+    {
+        return false;
+    }
+
+    out << "P6\n" << WIDTH << " " << HEIGHT << "\n255\n";
+    out.write(reinterpret_cast<char const*>(frameBuffer.data()), frameBuffer.size());
+    return !out.fail();
+}
+
+/// @brief Frame ready callback. Notes that the frame buffer holds a newly rendered frame.
+static void FrameRendered(void* userData)
+{
+    *static_cast<bool*>(userData) = true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> frameBuffer(FRAME_BUFFER_SIZE);
+    bool frameRendered = false;
+    std::unique_ptr<GBC_Instance, decltype(&GBC_Destroy)> gbc(GBC_Create(), GBC_Destroy);
+    Initialize(gbc.get(), frameBuffer.data(), FrameRendered, &frameRendered);
+
+    std::string romPath = options.romPath.string();
+    std::string bootRomPath = options.bootRomPath.string();
+    char saveDirectory[] = "";
+    char romName[17] = {};
+
+    if (!InsertCartridge(gbc.get(), romPath.data(), saveDirectory, romName))
+    {
+        std::fprintf(stderr, "Failed to load ROM: %s\n", romPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    PowerOn(gbc.get(), bootRomPath.data());
+    SetScanlineRenderer(gbc.get(), options.scanlineRenderer);
+    SetFrameSkip(gbc.get(), options.frameSkip);
+    SetInstructionStepping(gbc.get(), options.instructionStepping);
+
+    if (!options.saveStatePath.empty())
+    {
+        std::string saveStatePath = options.saveStatePath.string();
+
+        if (std::ifstream(options.saveStatePath, std::ios::binary).fail())
+        {
+            std::fprintf(stderr, "Failed to open save state: %s\n", saveStatePath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        LoadSaveState(gbc.get(), saveStatePath.data());
+    }
+
+    std::ofstream hashLog;
+
+    if (!options.hashLogPath.empty())
+    {
+        hashLog.open(options.hashLogPath);
+
+        if (hashLog.fail())
+        {
+            std::fprintf(stderr, "Failed to open hash log: %s\n", options.hashLogPath.string().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint64_t framesRun = 0;
+    auto const start = std::chrono::steady_clock::now();
+
+    while (((options.frames == 0) || (framesRun < options.frames)) &&
+           ((options.cycles == 0) || (GetCycleCount(gbc.get()) < options.cycles)))
+    {
+        frameRendered = false;
+
+        // Once a cycle limited run is closer to its end than RunFrames may run for, finish with RunUntil so that it stops exactly
+        // on time.
+        if ((options.cycles != 0) && ((options.cycles - GetCycleCount(gbc.get())) < GBC_MAX_M_CYCLES_PER_FRAME))
+        {
+            framesRun += RunUntil(gbc.get(), options.cycles);
+        }
+        else
+        {
+            framesRun += RunFrames(gbc.get(), 1);
+        }
+
+        // Skipped frames leave the frame buffer as it was, so only drawn frames are logged.
+        if (hashLog.is_open() && frameRendered)
+        {
+            hashLog << framesRun << " " << std::hex << HashFrameBuffer(frameBuffer.data(), frameBuffer.size()) << std::dec
+                    << "\n";
+        }
+    }
+
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t const cyclesRun = GetCycleCount(gbc.get());
+
+    if (!options.framePath.empty() && !WriteFrame(options.framePath, frameBuffer))
+    {
+        std::fprintf(stderr, "Failed to write frame: %s\n", options.framePath.string().c_str());
+    }
+
+    double const emulatedSeconds = cyclesRun / CPU_CLOCK_FREQUENCY;
+
+    std::printf("ROM:          %s\n", romName);
+    std::printf("Frames:       %llu\n", static_cast<unsigned long long>(framesRun));
+    std::printf("M-cycles:     %llu\n", static_cast<unsigned long long>(cyclesRun));
+    std::printf("Wall time:    %.3f s\n", seconds);
+    std::printf("FPS:          %.1f\n", framesRun / seconds);
+    std::printf("MHz:          %.2f (M-cycles per second / 1e6)\n", cyclesRun / seconds / 1e6);
+    std::printf("Speed:        %.1fx real time\n", emulatedSeconds / seconds);
+    std::printf("Final hash:   %016llx\n",
+                static_cast<unsigned long long>(HashFrameBuffer(frameBuffer.data(), frameBuffer.size())));
+
+    return EXIT_SUCCESS;
+}